@@ -0,0 +1,368 @@
+#pragma once
+
+#include "include.hpp"
+#include "matrix.hpp"
+#include "fixed_matrix.hpp"
+#include "parallel.hpp"
+
+/*
+math::MatrixBatch<NUMBER, LINES, COLUMNS> : a lot of small matrices of the same size, stored component by component
+(structure of arrays) => value (line, column) of matrix k is at component(line, column)[k]
+every operation goes through the matrices by groups of detail::batch_lanes, one matrix per SIMD lane :
+	math::MatrixBatch<float, 4, 4> transforms(1000000);
+	math::MatrixBatch<float, 4, 1> points(1000000);
+	math::MatrixBatch<float, 4, 1> moved = transforms.apply(points);
+the loops on a group have a fixed size and write to local arrays => the compiler vectorizes them, even at -O2
+*/
+
+namespace math {
+
+	namespace detail {
+
+		constexpr std::size_t batch_lanes = 16u; // matrices per group, the components are padded to a multiple of it
+		constexpr std::size_t batch_block = 1u << 12; // matrices per task
+
+		template<typename FUNCTION>
+		void batch_for(std::size_t size, FUNCTION const& function) {
+			// function(first) for the first matrix of every group, the blocks of groups are shared between the threads
+			math::parallel_for((size + batch_block - 1u) / batch_block, [&](std::size_t block) {
+				const std::size_t last = std::min(size, (block + 1u) * batch_block);
+				for (std::size_t first = block * batch_block; first < last; first += batch_lanes) {
+					function(first);
+				}
+			});
+		}
+	}
+
+	template<typename NUMBER, std::size_t LINES, std::size_t COLUMNS>
+	class MatrixBatch {
+		std::vector<NUMBER> vals_;
+		std::size_t size_ = 0u;
+		std::size_t stride_ = 0u; // distance between two components, multiple of detail::batch_lanes
+
+		static constexpr std::size_t components = LINES * COLUMNS;
+
+		static inline std::size_t padded(std::size_t size) {
+			return (size + detail::batch_lanes - 1u) / detail::batch_lanes * detail::batch_lanes;
+		}
+
+		template<typename KERNEL>
+		static void store(MatrixBatch& result, std::size_t first, KERNEL const& kernel) {
+			// kernel(values) fills values[component][lane] for the group starting at first, then copied to result
+			NUMBER values[components][detail::batch_lanes];
+			kernel(values);
+			for (std::size_t component = 0; component < components; component++) {
+				std::copy(values[component], values[component] + detail::batch_lanes, result.component(component) + first);
+			}
+		}
+
+	public:
+		typedef NUMBER number_type;
+		typedef Matrix<NUMBER, LINES, COLUMNS> matrix_type;
+
+		explicit MatrixBatch(std::size_t size = 0u) : vals_(components * padded(size), NUMBER()), size_(size), stride_(padded(size)) {}
+
+		MatrixBatch(std::size_t size, matrix_type const& matrix) : MatrixBatch(size) { // size copies of matrix
+			for (std::size_t component = 0; component < components; component++) {
+				std::fill(this->component(component), this->component(component) + size_, matrix.data()[component]);
+			}
+		}
+
+		MatrixBatch(std::vector<matrix_type> const& matrices) : MatrixBatch(matrices.size()) {
+			for (std::size_t index = 0; index < size_; index++) {
+				set(index, matrices[index]);
+			}
+		}
+
+		explicit MatrixBatch(Matrix2D<NUMBER> const& matrices) : MatrixBatch(matrices.lines()) {
+			// one matrix per line of matrices, LINES * COLUMNS values line after line
+			if (matrices.columns() != components) {
+				error("math::MatrixBatch::MatrixBatch", "the lines of the Matrix2D have " + std::to_string(matrices.columns()) + " values, expected " + std::to_string(components));
+			}
+			for (std::size_t index = 0; index < size_; index++) {
+				NUMBER const* values = matrices.data() + index * matrices.stride();
+				for (std::size_t component = 0; component < components; component++) {
+					this->component(component)[index] = values[component];
+				}
+			}
+		}
+
+		static constexpr std::size_t lines() {
+			return LINES;
+		}
+
+		static constexpr std::size_t columns() {
+			return COLUMNS;
+		}
+
+		inline std::size_t size() const {
+			return size_;
+		}
+
+		inline std::size_t stride() const {
+			return stride_;
+		}
+
+		inline NUMBER* component(std::size_t index) { // index = line * COLUMNS + column, size() values
+			return vals_.data() + index * stride_;
+		}
+
+		inline NUMBER const* component(std::size_t index) const {
+			return vals_.data() + index * stride_;
+		}
+
+		inline NUMBER* component(std::size_t line, std::size_t column) {
+			return component(line * COLUMNS + column);
+		}
+
+		inline NUMBER const* component(std::size_t line, std::size_t column) const {
+			return component(line * COLUMNS + column);
+		}
+
+		inline NUMBER& operator()(std::size_t index, std::size_t line, std::size_t column) { // no bounds checking
+			return vals_[(line * COLUMNS + column) * stride_ + index];
+		}
+
+		inline NUMBER const& operator()(std::size_t index, std::size_t line, std::size_t column) const {
+			return vals_[(line * COLUMNS + column) * stride_ + index];
+		}
+
+		matrix_type get(std::size_t index) const {
+			if (index >= size_) {
+				error("math::MatrixBatch::get", "index (" + std::to_string(index) + ") >= size()");
+			}
+			matrix_type result;
+			for (std::size_t component = 0; component < components; component++) {
+				result.data()[component] = this->component(component)[index];
+			}
+			return result;
+		}
+
+		void set(std::size_t index, matrix_type const& matrix) {
+			if (index >= size_) {
+				error("math::MatrixBatch::set", "index (" + std::to_string(index) + ") >= size()");
+			}
+			for (std::size_t component = 0; component < components; component++) {
+				this->component(component)[index] = matrix.data()[component];
+			}
+		}
+
+		void set(std::size_t index, Matrix2D<NUMBER> const& matrix) {
+			set(index, matrix_type(matrix));
+		}
+
+		void resize(std::size_t size) {
+			// new matrices are filled by NUMBER()
+			MatrixBatch result(size);
+			for (std::size_t component = 0; component < components; component++) {
+				std::copy(this->component(component), this->component(component) + std::min(size, size_), result.component(component));
+			}
+			*this = std::move(result);
+		}
+
+		Matrix2D<NUMBER> to_matrix2d() const {
+			// size() lines of LINES * COLUMNS values, same layout as the constructor
+			Matrix2D<NUMBER> result(size_, components);
+			for (std::size_t index = 0; index < size_; index++) {
+				NUMBER* values = result.data() + index * result.stride();
+				for (std::size_t component = 0; component < components; component++) {
+					values[component] = this->component(component)[index];
+				}
+			}
+			return result;
+		}
+
+		template<std::size_t K>
+		MatrixBatch<NUMBER, LINES, K> operator*(MatrixBatch<NUMBER, COLUMNS, K> const& batch) const {
+			// matrix k of the result = matrix k of *this * matrix k of batch
+			if (batch.size() != size_) {
+				error("math::MatrixBatch::operator*", "batches of different sizes (" + std::to_string(size_) + " and " + std::to_string(batch.size()) + ")");
+			}
+			MatrixBatch<NUMBER, LINES, K> result(size_);
+			detail::batch_for(size_, [&](std::size_t first) {
+				for (std::size_t i = 0; i < LINES; i++) {
+					for (std::size_t j = 0; j < K; j++) {
+						NUMBER values[detail::batch_lanes];
+						NUMBER const* a = component(i, 0u) + first;
+						NUMBER const* b = batch.component(0u, j) + first;
+						for (std::size_t lane = 0; lane < detail::batch_lanes; lane++) {
+							values[lane] = a[lane] * b[lane];
+						}
+						for (std::size_t l = 1; l < COLUMNS; l++) {
+							a = component(i, l) + first;
+							b = batch.component(l, j) + first;
+							for (std::size_t lane = 0; lane < detail::batch_lanes; lane++) {
+								values[lane] += a[lane] * b[lane];
+							}
+						}
+						std::copy(values, values + detail::batch_lanes, result.component(i, j) + first);
+					}
+				}
+			});
+			return result;
+		}
+
+		MatrixBatch<NUMBER, LINES, 1u> apply(MatrixBatch<NUMBER, COLUMNS, 1u> const& vectors) const {
+			// vector k of the result = matrix k * vector k
+			return *this * vectors;
+		}
+
+		std::vector<NUMBER> determinant() const {
+			// closed forms up to 4x4 (vectorized), math::Matrix::determinant one matrix at a time for the bigger ones
+			static_assert(LINES == COLUMNS, "math::MatrixBatch::determinant : the matrices must be square");
+			std::vector<NUMBER> result(stride_);
+			if constexpr (LINES > 4u) {
+				detail::batch_for(size_, [&](std::size_t first) {
+					for (std::size_t index = first; index < std::min(size_, first + detail::batch_lanes); index++) {
+						result[index] = get(index).determinant();
+					}
+				});
+			}
+			else {
+				detail::batch_for(size_, [&](std::size_t first) {
+					NUMBER values[detail::batch_lanes];
+					group_determinant(first, values);
+					std::copy(values, values + detail::batch_lanes, result.data() + first);
+				});
+			}
+			result.resize(size_);
+			return result;
+		}
+
+		MatrixBatch inverse() const {
+			// adjugate / determinant up to 4x4 for floating point values (vectorized), math::Matrix::inverse otherwise
+			static_assert(LINES == COLUMNS, "math::MatrixBatch::inverse : the matrices must be square");
+			MatrixBatch result(size_);
+			if constexpr (LINES > 4u || !std::is_floating_point<NUMBER>::value) {
+				detail::batch_for(size_, [&](std::size_t first) {
+					for (std::size_t index = first; index < std::min(size_, first + detail::batch_lanes); index++) {
+						result.set(index, get(index).inverse());
+					}
+				});
+			}
+			else {
+				detail::batch_for(size_, [&](std::size_t first) {
+					NUMBER determinants[detail::batch_lanes];
+					group_determinant(first, determinants);
+					for (std::size_t lane = 0; lane < detail::batch_lanes && first + lane < size_; lane++) {
+						if (determinants[lane] == NUMBER()) {
+							error("math::MatrixBatch::inverse", "the matrix " + std::to_string(first + lane) + " is singular");
+						}
+					}
+					for (NUMBER& determinant : determinants) {
+						determinant = static_cast<NUMBER>(1) / determinant;
+					}
+					store(result, first, [&](NUMBER (&values)[components][detail::batch_lanes]) {
+						group_adjugate(first, determinants, values);
+					});
+				});
+			}
+			return result;
+		}
+
+	private:
+		void group_determinant(std::size_t first, NUMBER (&values)[detail::batch_lanes]) const {
+			// values[lane] = determinant of the matrix first + lane, the loop on the lanes is the vectorized one
+			for (std::size_t lane = 0; lane < detail::batch_lanes; lane++) {
+				values[lane] = lane_determinant(first + lane);
+			}
+		}
+
+		inline NUMBER lane_determinant(std::size_t index) const {
+			auto a = [&](std::size_t line, std::size_t column) -> NUMBER {
+				return component(line, column)[index];
+			};
+			if constexpr (LINES == 1u) {
+				return a(0, 0);
+			}
+			else if constexpr (LINES == 2u) {
+				return a(0, 0) * a(1, 1) - a(0, 1) * a(1, 0);
+			}
+			else if constexpr (LINES == 3u) {
+				return a(0, 0) * (a(1, 1) * a(2, 2) - a(1, 2) * a(2, 1)) - a(0, 1) * (a(1, 0) * a(2, 2) - a(1, 2) * a(2, 0)) + a(0, 2) * (a(1, 0) * a(2, 1) - a(1, 1) * a(2, 0));
+			}
+			else {
+				// 2x2 minors of the first two lines (s) and of the last two (c)
+				const NUMBER s0 = a(0, 0) * a(1, 1) - a(1, 0) * a(0, 1);
+				const NUMBER s1 = a(0, 0) * a(1, 2) - a(1, 0) * a(0, 2);
+				const NUMBER s2 = a(0, 0) * a(1, 3) - a(1, 0) * a(0, 3);
+				const NUMBER s3 = a(0, 1) * a(1, 2) - a(1, 1) * a(0, 2);
+				const NUMBER s4 = a(0, 1) * a(1, 3) - a(1, 1) * a(0, 3);
+				const NUMBER s5 = a(0, 2) * a(1, 3) - a(1, 2) * a(0, 3);
+				const NUMBER c0 = a(2, 0) * a(3, 1) - a(3, 0) * a(2, 1);
+				const NUMBER c1 = a(2, 0) * a(3, 2) - a(3, 0) * a(2, 2);
+				const NUMBER c2 = a(2, 0) * a(3, 3) - a(3, 0) * a(2, 3);
+				const NUMBER c3 = a(2, 1) * a(3, 2) - a(3, 1) * a(2, 2);
+				const NUMBER c4 = a(2, 1) * a(3, 3) - a(3, 1) * a(2, 3);
+				const NUMBER c5 = a(2, 2) * a(3, 3) - a(3, 2) * a(2, 3);
+				return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+			}
+		}
+
+		void group_adjugate(std::size_t first, NUMBER const (&factors)[detail::batch_lanes], NUMBER (&values)[components][detail::batch_lanes]) const {
+			// values[component][lane] = factors[lane] * adjugate of the matrix first + lane
+			for (std::size_t lane = 0; lane < detail::batch_lanes; lane++) {
+				lane_adjugate(first + lane, values, lane, factors[lane]);
+			}
+		}
+
+		inline void lane_adjugate(std::size_t index, NUMBER (&values)[components][detail::batch_lanes], std::size_t lane, NUMBER factor) const {
+			auto a = [&](std::size_t line, std::size_t column) -> NUMBER {
+				return component(line, column)[index];
+			};
+			if constexpr (LINES == 1u) {
+				values[0][lane] = factor;
+			}
+			else if constexpr (LINES == 2u) {
+				values[0][lane] = a(1, 1) * factor;
+				values[1][lane] = -a(0, 1) * factor;
+				values[2][lane] = -a(1, 0) * factor;
+				values[3][lane] = a(0, 0) * factor;
+			}
+			else if constexpr (LINES == 3u) {
+				detail::unroll<9u>([&](std::size_t component) {
+					// cofactor of (j, i), the indexes modulo 3 give the sign for free
+					const std::size_t i = component / 3u;
+					const std::size_t j = component % 3u;
+					const std::size_t l0 = (j + 1u) % 3u, l1 = (j + 2u) % 3u, c0 = (i + 1u) % 3u, c1 = (i + 2u) % 3u;
+					values[component][lane] = (a(l0, c0) * a(l1, c1) - a(l0, c1) * a(l1, c0)) * factor;
+				});
+			}
+			else {
+				const NUMBER s0 = a(0, 0) * a(1, 1) - a(1, 0) * a(0, 1);
+				const NUMBER s1 = a(0, 0) * a(1, 2) - a(1, 0) * a(0, 2);
+				const NUMBER s2 = a(0, 0) * a(1, 3) - a(1, 0) * a(0, 3);
+				const NUMBER s3 = a(0, 1) * a(1, 2) - a(1, 1) * a(0, 2);
+				const NUMBER s4 = a(0, 1) * a(1, 3) - a(1, 1) * a(0, 3);
+				const NUMBER s5 = a(0, 2) * a(1, 3) - a(1, 2) * a(0, 3);
+				const NUMBER c0 = a(2, 0) * a(3, 1) - a(3, 0) * a(2, 1);
+				const NUMBER c1 = a(2, 0) * a(3, 2) - a(3, 0) * a(2, 2);
+				const NUMBER c2 = a(2, 0) * a(3, 3) - a(3, 0) * a(2, 3);
+				const NUMBER c3 = a(2, 1) * a(3, 2) - a(3, 1) * a(2, 2);
+				const NUMBER c4 = a(2, 1) * a(3, 3) - a(3, 1) * a(2, 3);
+				const NUMBER c5 = a(2, 2) * a(3, 3) - a(3, 2) * a(2, 3);
+				values[0][lane] = (a(1, 1) * c5 - a(1, 2) * c4 + a(1, 3) * c3) * factor;
+				values[1][lane] = (-a(0, 1) * c5 + a(0, 2) * c4 - a(0, 3) * c3) * factor;
+				values[2][lane] = (a(3, 1) * s5 - a(3, 2) * s4 + a(3, 3) * s3) * factor;
+				values[3][lane] = (-a(2, 1) * s5 + a(2, 2) * s4 - a(2, 3) * s3) * factor;
+				values[4][lane] = (-a(1, 0) * c5 + a(1, 2) * c2 - a(1, 3) * c1) * factor;
+				values[5][lane] = (a(0, 0) * c5 - a(0, 2) * c2 + a(0, 3) * c1) * factor;
+				values[6][lane] = (-a(3, 0) * s5 + a(3, 2) * s2 - a(3, 3) * s1) * factor;
+				values[7][lane] = (a(2, 0) * s5 - a(2, 2) * s2 + a(2, 3) * s1) * factor;
+				values[8][lane] = (a(1, 0) * c4 - a(1, 1) * c2 + a(1, 3) * c0) * factor;
+				values[9][lane] = (-a(0, 0) * c4 + a(0, 1) * c2 - a(0, 3) * c0) * factor;
+				values[10][lane] = (a(3, 0) * s4 - a(3, 1) * s2 + a(3, 3) * s0) * factor;
+				values[11][lane] = (-a(2, 0) * s4 + a(2, 1) * s2 - a(2, 3) * s0) * factor;
+				values[12][lane] = (-a(1, 0) * c3 + a(1, 1) * c1 - a(1, 2) * c0) * factor;
+				values[13][lane] = (a(0, 0) * c3 - a(0, 1) * c1 + a(0, 2) * c0) * factor;
+				values[14][lane] = (-a(3, 0) * s3 + a(3, 1) * s1 - a(3, 2) * s0) * factor;
+				values[15][lane] = (a(2, 0) * s3 - a(2, 1) * s1 + a(2, 2) * s0) * factor;
+			}
+		}
+	};
+
+	typedef math::MatrixBatch<float, 3, 3> FMatrixBatch3x3;
+	typedef math::MatrixBatch<float, 4, 4> FMatrixBatch4x4;
+	typedef math::MatrixBatch<double, 3, 3> DMatrixBatch3x3;
+	typedef math::MatrixBatch<double, 4, 4> DMatrixBatch4x4;
+}
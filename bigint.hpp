@@ -0,0 +1,756 @@
+#pragma once
+
+#include "include.hpp"
+#include "frac.hpp"
+#include <cstdint>
+#include <string_view>
+
+/*
+math::BigInt : integer of any size, sign + magnitude in base 2^32 limbs (little endian)
+	math::BigInt a("123456789012345678901234567890");
+	math::BIFrac f(a, 7); // math::Frac<math::BigInt> never overflows
+values that fit in a long long take the native path (overflow builtins) and only switch to limbs when the result doesn't fit
+up to detail::LimbVector::inline_capacity limbs (256 bits) the limbs are stored in the object itself => no allocation
+multiplication : schoolbook, Karatsuba above detail::karatsuba_threshold limbs
+division : Knuth's algorithm D, gcd : Lehmer (math::gcd)
+*/
+
+namespace math {
+
+	namespace detail {
+
+		typedef std::uint32_t limb;
+		typedef std::uint64_t double_limb;
+
+		constexpr std::size_t karatsuba_threshold = 32u; // limbs
+
+		class LimbVector {
+			// std::vector<limb> with the first inline_capacity limbs stored in the object
+		public:
+			static constexpr std::size_t inline_capacity = 8u;
+
+		private:
+			limb inline_[inline_capacity] = {};
+			std::vector<limb> heap_; // used once the size goes above inline_capacity
+			std::size_t size_ = 0u;
+
+		public:
+			inline std::size_t size() const {
+				return size_;
+			}
+
+			inline limb* data() {
+				return heap_.empty() ? inline_ : heap_.data();
+			}
+
+			inline limb const* data() const {
+				return heap_.empty() ? inline_ : heap_.data();
+			}
+
+			inline limb& operator[](std::size_t index) {
+				return data()[index];
+			}
+
+			inline limb const& operator[](std::size_t index) const {
+				return data()[index];
+			}
+
+			void resize(std::size_t size) { // new limbs are 0
+				if (heap_.empty()) {
+					if (size <= inline_capacity) {
+						std::fill(inline_ + std::min(size_, size), inline_ + inline_capacity, 0u);
+						size_ = size;
+						return;
+					}
+					heap_.assign(inline_, inline_ + size_);
+				}
+				heap_.resize(size, 0u);
+				size_ = size;
+			}
+
+			inline void trim() { // removes the leading zero limbs
+				std::size_t size = size_;
+				while (size != 0u && data()[size - 1u] == 0u) {
+					size--;
+				}
+				resize(size);
+			}
+		};
+
+		inline int leading_zeros(limb value) { // value != 0
+#if defined(__GNUC__)
+			return __builtin_clz(value);
+#else
+			int result = 0;
+			for (; (value & 0x80000000u) == 0u; value <<= 1) {
+				result++;
+			}
+			return result;
+#endif
+		}
+
+		inline std::size_t trimmed(limb const* a, std::size_t size) {
+			while (size != 0u && a[size - 1u] == 0u) {
+				size--;
+			}
+			return size;
+		}
+
+		inline int compare_limbs(limb const* a, std::size_t a_size, limb const* b, std::size_t b_size) {
+			// a and b without leading zeros
+			if (a_size != b_size) {
+				return a_size < b_size ? -1 : 1;
+			}
+			for (std::size_t i = a_size; i-- > 0u;) {
+				if (a[i] != b[i]) {
+					return a[i] < b[i] ? -1 : 1;
+				}
+			}
+			return 0;
+		}
+
+		inline limb add_limbs(limb* result, limb const* a, std::size_t a_size, limb const* b, std::size_t b_size) {
+			// result[0, a_size) = a + b, a_size >= b_size, returns the carry, result can be a
+			double_limb carry = 0u;
+			std::size_t i = 0;
+			for (; i < b_size; i++) {
+				carry += static_cast<double_limb>(a[i]) + b[i];
+				result[i] = static_cast<limb>(carry);
+				carry >>= 32;
+			}
+			for (; i < a_size; i++) {
+				carry += a[i];
+				result[i] = static_cast<limb>(carry);
+				carry >>= 32;
+			}
+			return static_cast<limb>(carry);
+		}
+
+		inline void add_into(limb* result, std::size_t result_size, limb const* b, std::size_t b_size) {
+			// result += b, the carry stops at the end of result
+			double_limb carry = 0u;
+			std::size_t i = 0;
+			for (; i < b_size; i++) {
+				carry += static_cast<double_limb>(result[i]) + b[i];
+				result[i] = static_cast<limb>(carry);
+				carry >>= 32;
+			}
+			for (; carry != 0u && i < result_size; i++) {
+				carry += result[i];
+				result[i] = static_cast<limb>(carry);
+				carry >>= 32;
+			}
+		}
+
+		inline void sub_limbs(limb* result, limb const* a, std::size_t a_size, limb const* b, std::size_t b_size) {
+			// result[0, a_size) = a - b, a >= b, result can be a
+			std::int64_t borrow = 0;
+			std::size_t i = 0;
+			for (; i < b_size; i++) {
+				const std::int64_t difference = static_cast<std::int64_t>(a[i]) - b[i] - borrow;
+				result[i] = static_cast<limb>(difference);
+				borrow = difference < 0 ? 1 : 0;
+			}
+			for (; i < a_size; i++) {
+				const std::int64_t difference = static_cast<std::int64_t>(a[i]) - borrow;
+				result[i] = static_cast<limb>(difference);
+				borrow = difference < 0 ? 1 : 0;
+			}
+		}
+
+		inline void multiply_schoolbook(limb* result, limb const* a, std::size_t a_size, limb const* b, std::size_t b_size) {
+			// result[0, a_size + b_size) = a * b, result is filled by 0 before
+			for (std::size_t i = 0; i < a_size; i++) {
+				double_limb carry = 0u;
+				const double_limb factor = a[i];
+				for (std::size_t j = 0; j < b_size; j++) {
+					carry += factor * b[j] + result[i + j];
+					result[i + j] = static_cast<limb>(carry);
+					carry >>= 32;
+				}
+				result[i + b_size] = static_cast<limb>(carry);
+			}
+		}
+
+		inline void multiply_limbs(limb* result, limb const* a, std::size_t a_size, limb const* b, std::size_t b_size) {
+			// result[0, a_size + b_size) = a * b, result doesn't overlap a or b
+			if (a_size < b_size) {
+				std::swap(a, b);
+				std::swap(a_size, b_size);
+			}
+			std::fill(result, result + a_size + b_size, 0u);
+			if (b_size < karatsuba_threshold) {
+				multiply_schoolbook(result, a, a_size, b, b_size);
+				return;
+			}
+			if (a_size >= 2u * b_size) { // unbalanced : slices of a as big as b
+				std::vector<limb> part(2u * b_size);
+				for (std::size_t offset = 0; offset < a_size; offset += b_size) {
+					const std::size_t size = std::min(b_size, a_size - offset);
+					multiply_limbs(part.data(), a + offset, size, b, b_size);
+					add_into(result + offset, a_size + b_size - offset, part.data(), size + b_size);
+				}
+				return;
+			}
+			/*
+			Karatsuba, a = a1 * B^half + a0, b = b1 * B^half + b0 :
+			a * b = a1 b1 B^2half + ((a0 + a1)(b0 + b1) - a0 b0 - a1 b1) B^half + a0 b0 => 3 products instead of 4
+			*/
+			const std::size_t half = a_size / 2u; // b_size > half since a_size < 2 b_size
+			multiply_limbs(result, a, half, b, half); // a0 b0 in [0, 2 half)
+			multiply_limbs(result + 2u * half, a + half, a_size - half, b + half, b_size - half); // a1 b1 in [2 half, a_size + b_size)
+			const std::size_t a_sum_size = a_size - half + 1u;
+			const std::size_t b_sum_size = std::max(half, b_size - half) + 1u;
+			std::vector<limb> sums(a_sum_size + b_sum_size + a_sum_size + b_sum_size);
+			limb* a_sum = sums.data();
+			limb* b_sum = a_sum + a_sum_size;
+			limb* middle = b_sum + b_sum_size;
+			a_sum[a_sum_size - 1u] = add_limbs(a_sum, a + half, a_size - half, a, half);
+			if (b_size - half >= half) {
+				b_sum[b_sum_size - 1u] = add_limbs(b_sum, b + half, b_size - half, b, half);
+			}
+			else {
+				b_sum[b_sum_size - 1u] = add_limbs(b_sum, b, half, b + half, b_size - half);
+			}
+			multiply_limbs(middle, a_sum, a_sum_size, b_sum, b_sum_size);
+			const std::size_t middle_size = a_sum_size + b_sum_size;
+			sub_limbs(middle, middle, middle_size, result, trimmed(result, 2u * half));
+			sub_limbs(middle, middle, middle_size, result + 2u * half, trimmed(result + 2u * half, a_size + b_size - 2u * half));
+			add_into(result + half, a_size + b_size - half, middle, trimmed(middle, middle_size));
+		}
+
+		inline limb divide_small(limb* quotient, limb const* a, std::size_t a_size, limb divisor) {
+			// quotient[0, a_size) = a / divisor, returns the remainder, quotient can be a
+			double_limb remainder = 0u;
+			for (std::size_t i = a_size; i-- > 0u;) {
+				const double_limb current = (remainder << 32) | a[i];
+				quotient[i] = static_cast<limb>(current / divisor);
+				remainder = current % divisor;
+			}
+			return static_cast<limb>(remainder);
+		}
+
+		inline void divide_limbs(limb* quotient, limb* remainder, limb const* u, std::size_t m, limb const* v, std::size_t n) {
+			/*
+			Knuth's algorithm D : quotient[0, m - n + 1) = u / v, remainder[0, n) = u % v
+			m >= n >= 2, v[n - 1] != 0, quotient and remainder can be nullptr
+			*/
+			const int shift = leading_zeros(v[n - 1u]);
+			std::vector<limb> buffer(n + m + 1u);
+			limb* vn = buffer.data();
+			limb* un = vn + n;
+			for (std::size_t i = n - 1u; i > 0u; i--) {
+				vn[i] = static_cast<limb>((static_cast<double_limb>(v[i]) << shift) | (static_cast<double_limb>(v[i - 1u]) >> (32 - shift)));
+			}
+			vn[0] = static_cast<limb>(static_cast<double_limb>(v[0]) << shift);
+			un[m] = static_cast<limb>(static_cast<double_limb>(u[m - 1u]) >> (32 - shift));
+			for (std::size_t i = m - 1u; i > 0u; i--) {
+				un[i] = static_cast<limb>((static_cast<double_limb>(u[i]) << shift) | (static_cast<double_limb>(u[i - 1u]) >> (32 - shift)));
+			}
+			un[0] = static_cast<limb>(static_cast<double_limb>(u[0]) << shift);
+			constexpr double_limb base = 1ull << 32;
+			for (std::size_t j = m - n + 1u; j-- > 0u;) {
+				// estimate of the quotient digit from the 2 leading digits, wrong by at most 2
+				const double_limb numerator = (static_cast<double_limb>(un[j + n]) << 32) | un[j + n - 1u];
+				double_limb estimate = numerator / vn[n - 1u];
+				double_limb rest = numerator % vn[n - 1u];
+				while (estimate >= base || estimate * vn[n - 2u] > ((rest << 32) | un[j + n - 2u])) {
+					estimate--;
+					rest += vn[n - 1u];
+					if (rest >= base) {
+						break;
+					}
+				}
+				// un[j, j + n] -= estimate * vn
+				std::int64_t borrow = 0;
+				std::int64_t difference = 0;
+				for (std::size_t i = 0; i < n; i++) {
+					const double_limb product = estimate * vn[i];
+					difference = static_cast<std::int64_t>(un[i + j]) - borrow - static_cast<std::int64_t>(product & 0xFFFFFFFFu);
+					un[i + j] = static_cast<limb>(difference);
+					borrow = static_cast<std::int64_t>(product >> 32) - (difference >> 32);
+				}
+				difference = static_cast<std::int64_t>(un[j + n]) - borrow;
+				un[j + n] = static_cast<limb>(difference);
+				if (difference < 0) { // estimate was 1 too big : adds vn back
+					estimate--;
+					double_limb carry = 0u;
+					for (std::size_t i = 0; i < n; i++) {
+						carry += static_cast<double_limb>(un[i + j]) + vn[i];
+						un[i + j] = static_cast<limb>(carry);
+						carry >>= 32;
+					}
+					un[j + n] = static_cast<limb>(un[j + n] + carry);
+				}
+				if (quotient != nullptr) {
+					quotient[j] = static_cast<limb>(estimate);
+				}
+			}
+			if (remainder != nullptr) {
+				for (std::size_t i = 0; i < n; i++) {
+					remainder[i] = static_cast<limb>((static_cast<double_limb>(un[i]) >> shift) | (static_cast<double_limb>(un[i + 1u]) << (32 - shift)));
+				}
+			}
+		}
+	}
+
+	class BigInt {
+		detail::LimbVector limbs_; // magnitude, no leading zero limb => 0 has no limb
+		bool negative_ = false;
+
+		inline void trim() {
+			limbs_.trim();
+			if (limbs_.size() == 0u) {
+				negative_ = false;
+			}
+		}
+
+		void set_magnitude(unsigned long long int magnitude) {
+			limbs_.resize(2u);
+			limbs_[0] = static_cast<detail::limb>(magnitude);
+			limbs_[1] = static_cast<detail::limb>(magnitude >> 32);
+			trim();
+		}
+
+		inline bool small() const { // |value| < 2^63 => fits in a long long
+			return limbs_.size() < 2u || (limbs_.size() == 2u && limbs_[1] < 0x80000000u);
+		}
+
+		inline long long int small_value() const { // small() only
+			const unsigned long long int magnitude = limbs_.size() == 0u ? 0u : (limbs_.size() == 1u ? limbs_[0] : (static_cast<unsigned long long int>(limbs_[1]) << 32) | limbs_[0]);
+			return negative_ ? -static_cast<long long int>(magnitude) : static_cast<long long int>(magnitude);
+		}
+
+		static int compare_magnitude(BigInt const& a, BigInt const& b) {
+			return detail::compare_limbs(a.limbs_.data(), a.limbs_.size(), b.limbs_.data(), b.limbs_.size());
+		}
+
+		static BigInt add(BigInt const& a, BigInt const& b, bool negate_b) {
+			// a + b or a - b on the magnitudes
+			const bool b_negative = b.negative_ != negate_b;
+			BigInt result;
+			if (a.negative_ == b_negative) {
+				BigInt const& big = a.limbs_.size() >= b.limbs_.size() ? a : b;
+				BigInt const& other = a.limbs_.size() >= b.limbs_.size() ? b : a;
+				result.limbs_.resize(big.limbs_.size() + 1u);
+				result.limbs_[big.limbs_.size()] = detail::add_limbs(result.limbs_.data(), big.limbs_.data(), big.limbs_.size(), other.limbs_.data(), other.limbs_.size());
+				result.negative_ = a.negative_;
+			}
+			else {
+				const int order = compare_magnitude(a, b);
+				if (order == 0) {
+					return result;
+				}
+				BigInt const& big = order > 0 ? a : b;
+				BigInt const& other = order > 0 ? b : a;
+				result.limbs_.resize(big.limbs_.size());
+				detail::sub_limbs(result.limbs_.data(), big.limbs_.data(), big.limbs_.size(), other.limbs_.data(), other.limbs_.size());
+				result.negative_ = order > 0 ? a.negative_ : b_negative;
+			}
+			result.trim();
+			return result;
+		}
+
+		static void divide(BigInt const& a, BigInt const& b, BigInt* quotient, BigInt* remainder) {
+			// truncated division (same signs as the operators of int)
+			if (b.limbs_.size() == 0u) {
+				error("math::BigInt::operator/", "division by 0");
+			}
+			BigInt q;
+			BigInt r;
+			if (compare_magnitude(a, b) < 0) {
+				r = a;
+			}
+			else if (b.limbs_.size() == 1u) {
+				q.limbs_.resize(a.limbs_.size());
+				r.set_magnitude(detail::divide_small(q.limbs_.data(), a.limbs_.data(), a.limbs_.size(), b.limbs_[0]));
+			}
+			else {
+				q.limbs_.resize(a.limbs_.size() - b.limbs_.size() + 1u);
+				r.limbs_.resize(b.limbs_.size());
+				detail::divide_limbs(q.limbs_.data(), r.limbs_.data(), a.limbs_.data(), a.limbs_.size(), b.limbs_.data(), b.limbs_.size());
+			}
+			q.negative_ = a.negative_ != b.negative_;
+			q.trim();
+			r.negative_ = a.negative_;
+			r.trim();
+			if (quotient != nullptr) {
+				*quotient = std::move(q);
+			}
+			if (remainder != nullptr) {
+				*remainder = std::move(r);
+			}
+		}
+
+		unsigned long long int low_bits(std::size_t shift) const {
+			// 64 bits of the magnitude starting at bit shift
+			unsigned long long int result = 0u;
+			const std::size_t first = shift / 32u;
+			const int offset = static_cast<int>(shift % 32u);
+			for (std::size_t i = 0; i < 3u && first + i < limbs_.size(); i++) {
+				const unsigned long long int value = limbs_[first + i];
+				const int position = static_cast<int>(i) * 32 - offset;
+				result |= position >= 0 ? (position < 64 ? value << position : 0u) : value >> -position;
+			}
+			return result;
+		}
+
+		void multiply_add_small(detail::limb factor, detail::limb addend) {
+			// *this = *this * factor + addend on the magnitude
+			detail::double_limb carry = addend;
+			for (std::size_t i = 0; i < limbs_.size(); i++) {
+				carry += static_cast<detail::double_limb>(limbs_[i]) * factor;
+				limbs_[i] = static_cast<detail::limb>(carry);
+				carry >>= 32;
+			}
+			if (carry != 0u) {
+				limbs_.resize(limbs_.size() + 1u);
+				limbs_[limbs_.size() - 1u] = static_cast<detail::limb>(carry);
+			}
+		}
+
+		friend BigInt gcd(BigInt a, BigInt b);
+
+	public:
+		BigInt(long long int value = 0) {
+			negative_ = value < 0;
+			set_magnitude(negative_ ? 0ull - static_cast<unsigned long long int>(value) : static_cast<unsigned long long int>(value));
+			negative_ = value < 0;
+		}
+
+		BigInt(int value) : BigInt(static_cast<long long int>(value)) {}
+
+		BigInt(long int value) : BigInt(static_cast<long long int>(value)) {}
+
+		BigInt(unsigned long long int value) {
+			set_magnitude(value);
+		}
+
+		BigInt(unsigned int value) : BigInt(static_cast<unsigned long long int>(value)) {}
+
+		BigInt(unsigned long int value) : BigInt(static_cast<unsigned long long int>(value)) {}
+
+		explicit BigInt(std::string_view text) {
+			// decimal, optional sign, error on anything else
+			std::size_t position = 0u;
+			bool negative = false;
+			if (position < text.size() && (text[position] == '-' || text[position] == '+')) {
+				negative = text[position] == '-';
+				position++;
+			}
+			if (position == text.size()) {
+				error("math::BigInt::BigInt", "invalid integer : " + std::string(text));
+			}
+			for (; position < text.size(); position += 9u) { // 9 digits at a time
+				const std::size_t count = std::min<std::size_t>(9u, text.size() - position);
+				detail::double_limb chunk = 0u;
+				detail::double_limb scale = 1u;
+				for (std::size_t i = 0; i < count; i++) {
+					const char c = text[position + i];
+					if (c < '0' || c > '9') {
+						error("math::BigInt::BigInt", "invalid integer : " + std::string(text));
+					}
+					chunk = chunk * 10u + static_cast<detail::double_limb>(c - '0');
+					scale *= 10u;
+				}
+				multiply_add_small(static_cast<detail::limb>(scale), static_cast<detail::limb>(chunk));
+			}
+			negative_ = negative;
+			trim();
+		}
+
+		explicit BigInt(char const* text) : BigInt(std::string_view(text)) {}
+
+		explicit BigInt(std::string const& text) : BigInt(std::string_view(text)) {}
+
+		explicit BigInt(double value) {
+			// truncated toward 0
+			negative_ = value < 0.;
+			value = std::trunc(std::abs(value));
+			std::vector<detail::limb> limbs;
+			while (value >= 1.) {
+				const double high = std::floor(value / 4294967296.);
+				limbs.push_back(static_cast<detail::limb>(value - high * 4294967296.));
+				value = high;
+			}
+			limbs_.resize(limbs.size());
+			std::copy(limbs.begin(), limbs.end(), limbs_.data());
+			trim();
+		}
+
+		inline bool is_zero() const {
+			return limbs_.size() == 0u;
+		}
+
+		inline bool is_negative() const {
+			return negative_;
+		}
+
+		inline int sign() const {
+			return is_zero() ? 0 : (negative_ ? -1 : 1);
+		}
+
+		inline std::size_t limbs() const { // number of 32-bit limbs of the magnitude
+			return limbs_.size();
+		}
+
+		inline detail::limb const* data() const {
+			return limbs_.data();
+		}
+
+		std::size_t bit_length() const { // 0 for 0
+			if (is_zero()) {
+				return 0u;
+			}
+			return limbs_.size() * 32u - static_cast<std::size_t>(detail::leading_zeros(limbs_[limbs_.size() - 1u]));
+		}
+
+		inline bool fits_long_long() const {
+			return small() || (negative_ && limbs_.size() == 2u && limbs_[1] == 0x80000000u && limbs_[0] == 0u);
+		}
+
+		explicit operator long long int() const { // truncated to 64 bits when it doesn't fit
+			if (small()) {
+				return small_value();
+			}
+			const unsigned long long int magnitude = low_bits(0u);
+			return static_cast<long long int>(negative_ ? 0ull - magnitude : magnitude);
+		}
+
+		explicit operator int() const {
+			return static_cast<int>(static_cast<long long int>(*this));
+		}
+
+		explicit operator double() const {
+			double result = 0.;
+			for (std::size_t i = limbs_.size(); i-- > 0u;) {
+				result = result * 4294967296. + limbs_[i];
+			}
+			return negative_ ? -result : result;
+		}
+
+		explicit operator long double() const {
+			long double result = 0.;
+			for (std::size_t i = limbs_.size(); i-- > 0u;) {
+				result = result * 4294967296.L + limbs_[i];
+			}
+			return negative_ ? -result : result;
+		}
+
+		explicit operator float() const {
+			return static_cast<float>(static_cast<double>(*this));
+		}
+
+		std::string to_string() const {
+			if (is_zero()) {
+				return "0";
+			}
+			std::vector<detail::limb> magnitude(limbs_.data(), limbs_.data() + limbs_.size());
+			std::vector<detail::limb> chunks; // groups of 9 digits, the last one first
+			std::size_t size = magnitude.size();
+			while (size != 0u) {
+				chunks.push_back(detail::divide_small(magnitude.data(), magnitude.data(), size, 1000000000u));
+				size = detail::trimmed(magnitude.data(), size);
+			}
+			std::string result = negative_ ? "-" : "";
+			result += std::to_string(chunks.back());
+			for (std::size_t i = chunks.size() - 1u; i-- > 0u;) {
+				const std::string digits = std::to_string(chunks[i]);
+				result.append(9u - digits.size(), '0');
+				result += digits;
+			}
+			return result;
+		}
+
+		BigInt operator-() const {
+			BigInt result = *this;
+			result.negative_ = !negative_ && !is_zero();
+			return result;
+		}
+
+		inline BigInt& operator+=(BigInt const& number) {
+			return *this = *this + number;
+		}
+
+		inline BigInt& operator-=(BigInt const& number) {
+			return *this = *this - number;
+		}
+
+		inline BigInt& operator*=(BigInt const& number) {
+			return *this = *this * number;
+		}
+
+		inline BigInt& operator/=(BigInt const& number) {
+			return *this = *this / number;
+		}
+
+		inline BigInt& operator%=(BigInt const& number) {
+			return *this = *this % number;
+		}
+
+		friend BigInt operator+(BigInt const& a, BigInt const& b) {
+#if defined(__GNUC__)
+			long long int result;
+			if (a.small() && b.small() && !__builtin_add_overflow(a.small_value(), b.small_value(), &result)) {
+				return BigInt(result);
+			}
+#endif
+			return add(a, b, false);
+		}
+
+		friend BigInt operator-(BigInt const& a, BigInt const& b) {
+#if defined(__GNUC__)
+			long long int result;
+			if (a.small() && b.small() && !__builtin_sub_overflow(a.small_value(), b.small_value(), &result)) {
+				return BigInt(result);
+			}
+#endif
+			return add(a, b, true);
+		}
+
+		friend BigInt operator*(BigInt const& a, BigInt const& b) {
+#if defined(__GNUC__)
+			long long int product;
+			if (a.small() && b.small() && !__builtin_mul_overflow(a.small_value(), b.small_value(), &product)) {
+				return BigInt(product);
+			}
+#endif
+			BigInt result;
+			if (a.is_zero() || b.is_zero()) {
+				return result;
+			}
+			result.limbs_.resize(a.limbs_.size() + b.limbs_.size());
+			detail::multiply_limbs(result.limbs_.data(), a.limbs_.data(), a.limbs_.size(), b.limbs_.data(), b.limbs_.size());
+			result.negative_ = a.negative_ != b.negative_;
+			result.trim();
+			return result;
+		}
+
+		friend BigInt operator/(BigInt const& a, BigInt const& b) {
+			if (a.small() && b.small() && !b.is_zero()) {
+				return BigInt(a.small_value() / b.small_value());
+			}
+			BigInt result;
+			divide(a, b, &result, nullptr);
+			return result;
+		}
+
+		friend BigInt operator%(BigInt const& a, BigInt const& b) {
+			if (a.small() && b.small() && !b.is_zero()) {
+				return BigInt(a.small_value() % b.small_value());
+			}
+			BigInt result;
+			divide(a, b, nullptr, &result);
+			return result;
+		}
+
+		friend bool operator==(BigInt const& a, BigInt const& b) {
+			return a.negative_ == b.negative_ && compare_magnitude(a, b) == 0;
+		}
+
+		friend bool operator!=(BigInt const& a, BigInt const& b) {
+			return !(a == b);
+		}
+
+		friend bool operator<(BigInt const& a, BigInt const& b) {
+			if (a.negative_ != b.negative_) {
+				return a.negative_;
+			}
+			const int order = compare_magnitude(a, b);
+			return a.negative_ ? order > 0 : order < 0;
+		}
+
+		friend bool operator>(BigInt const& a, BigInt const& b) {
+			return b < a;
+		}
+
+		friend bool operator<=(BigInt const& a, BigInt const& b) {
+			return !(b < a);
+		}
+
+		friend bool operator>=(BigInt const& a, BigInt const& b) {
+			return !(a < b);
+		}
+	};
+
+	inline BigInt abs(BigInt const& number) {
+		return number.is_negative() ? -number : number;
+	}
+
+	inline BigInt gcd(BigInt a, BigInt b) {
+		/*
+		Lehmer : the steps of Euclid's algorithm are simulated on the 62 leading bits of a and b (single precision)
+		as long as the quotients are sure, then applied to a and b at once => a few big operations instead of one per quotient
+		*/
+		a.negative_ = false;
+		b.negative_ = false;
+		if (a < b) {
+			std::swap(a, b);
+		}
+		while (b.limbs_.size() > 2u) {
+			const std::size_t shift = a.bit_length() - 62u;
+			long long int x = static_cast<long long int>(a.low_bits(shift));
+			long long int y = static_cast<long long int>(b.low_bits(shift));
+			long long int A = 1, B = 0, C = 0, D = 1; // a' = A a + B b, b' = C a + D b
+			while (y + C != 0 && y + D != 0) {
+				const long long int q = (x + A) / (y + C);
+				if (q != (x + B) / (y + D)) {
+					break;
+				}
+				long long int t = A - q * C;
+				A = C;
+				C = t;
+				t = B - q * D;
+				B = D;
+				D = t;
+				t = x - q * y;
+				x = y;
+				y = t;
+			}
+			if (B == 0) { // no sure quotient : one step of Euclid's algorithm on the big values
+				BigInt rest = a % b;
+				a = std::move(b);
+				b = std::move(rest);
+			}
+			else {
+				BigInt next_a = a * BigInt(A) + b * BigInt(B);
+				b = a * BigInt(C) + b * BigInt(D);
+				a = std::move(next_a);
+			}
+		}
+		if (b.is_zero()) {
+			return a;
+		}
+		// b fits in 64 bits : one division brings a there too
+		const unsigned long long int small_b = b.low_bits(0u);
+		const unsigned long long int small_a = (a % b).low_bits(0u);
+		return BigInt(static_cast<unsigned long long int>(detail::binary_gcd(small_a, small_b)));
+	}
+
+	typedef math::Frac<math::BigInt> BIFrac;
+}
+
+inline std::ostream& operator<<(std::ostream& stream, math::BigInt const& number) {
+	return stream << number.to_string();
+}
+
+inline std::istream& operator>>(std::istream& stream, math::BigInt& number) {
+	std::string text;
+	if (stream >> text) {
+		number = math::BigInt(std::string_view(text));
+	}
+	return stream;
+}
+
+namespace std {
+	template<>
+	struct hash<math::BigInt> {
+		std::size_t operator()(math::BigInt const& number) const {
+			std::size_t result = number.is_negative() ? 1u : 0u;
+			for (std::size_t i = 0; i < number.limbs(); i++) {
+				result = math::detail::hash_combine(result, number.data()[i]);
+			}
+			return result;
+		}
+	};
+}
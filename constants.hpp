@@ -1,10 +1,10 @@
-#pragma once
-
-#ifndef DISABLE_CONSTANTS
-
-namespace math {
-	constexpr double pi = 3.14159265358979323846;
-	constexpr double e = 2.71828182845904523536;
-}
-
+#pragma once
+
+#ifndef DISABLE_CONSTANTS
+
+namespace math {
+	constexpr double pi = 3.14159265358979323846;
+	constexpr double e = 2.71828182845904523536;
+}
+
 #endif
\ No newline at end of file
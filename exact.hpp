@@ -0,0 +1,328 @@
+#pragma once
+
+#include "include.hpp"
+#include "matrix.hpp"
+#include "frac.hpp"
+#include "bigint.hpp"
+
+/*
+exact linear algebra on integer and math::Frac matrices, without any fraction during the elimination (Bareiss) :
+	a[i][j] = (pivot * a[i][j] - a[i][column] * a[line][j]) / previous_pivot
+every division is exact and every value stays a minor of the matrix => the values grow linearly, not exponentially
+the results are converted to math::Frac once, at the end
+a Frac matrix is first turned into an integer one by multiplying each line by the lcm of its denominators
+the elimination runs on a wider integer (long long for int, __int128 for long long when available), error on overflow
+with math::BigInt (or math::BIFrac) values it runs on math::BigInt and never overflows
+*/
+
+namespace math {
+
+	namespace detail {
+
+		template<typename INTEGER>
+		struct exact_work { // integer used during the elimination
+			typedef long long int type;
+		};
+
+#ifdef __SIZEOF_INT128__
+		template<>
+		struct exact_work<long long int> {
+			typedef __int128 type;
+		};
+
+		template<>
+		struct exact_work<long int> {
+			typedef __int128 type;
+		};
+#endif
+
+		template<>
+		struct exact_work<BigInt> {
+			typedef BigInt type;
+		};
+
+		template<typename INTEGER>
+		struct exact_integral : std::integral_constant<bool, std::is_integral<INTEGER>::value || std::is_same<INTEGER, BigInt>::value> {};
+
+		template<typename WORK>
+		inline WORK exact_abs(WORK value) {
+			return value < 0 ? -value : value;
+		}
+
+		template<typename WORK>
+		inline WORK exact_gcd(WORK a, WORK b) {
+			a = exact_abs(a);
+			b = exact_abs(b);
+			while (b != 0) {
+				const WORK rest = a % b;
+				a = b;
+				b = rest;
+			}
+			return a;
+		}
+
+		template<typename INTEGER, typename WORK>
+		inline INTEGER exact_narrow(WORK value, std::string const& func_name) {
+			if (static_cast<WORK>(static_cast<INTEGER>(value)) != value) {
+				error(func_name, "the result doesn't fit in the integer type of the matrix");
+			}
+			return static_cast<INTEGER>(value);
+		}
+
+		template<typename WORK>
+		inline WORK exact_multiply(WORK a, WORK b) {
+			if constexpr (std::is_class<WORK>::value) { // math::BigInt
+				return a * b;
+			}
+			else {
+#if defined(__GNUC__)
+				WORK result;
+				if (__builtin_mul_overflow(a, b, &result)) {
+					error("math::exact", "overflow, the values of the matrix are too big for its integer type");
+				}
+				return result;
+#else
+				return a * b;
+#endif
+			}
+		}
+
+		template<typename WORK>
+		inline WORK exact_step(WORK pivot, WORK value, WORK factor, WORK line_value, WORK previous) {
+			// (pivot * value - factor * line_value) / previous, exact
+			const WORK a = exact_multiply(pivot, value);
+			const WORK b = exact_multiply(factor, line_value);
+			if constexpr (std::is_class<WORK>::value) {
+				return (a - b) / previous;
+			}
+			else {
+#if defined(__GNUC__)
+				WORK difference;
+				if (__builtin_sub_overflow(a, b, &difference)) {
+					error("math::exact", "overflow, the values of the matrix are too big for its integer type");
+				}
+				return difference / previous;
+#else
+				return (a - b) / previous;
+#endif
+			}
+		}
+
+		template<typename WORK>
+		class FractionFree {
+			// lines x columns integer matrix and the fraction-free gauss-jordan elimination on it
+			std::vector<WORK> vals_;
+			std::size_t lines_ = 0u;
+			std::size_t columns_ = 0u;
+			std::vector<std::size_t> pivots_; // column of the pivot of each line of the echelon form
+			WORK pivot_ = 1; // after reduce(), every pivot is equal to this value
+			bool odd_ = false; // odd number of line swaps
+
+		public:
+			FractionFree(std::size_t lines, std::size_t columns) : vals_(lines * columns, 0), lines_(lines), columns_(columns) {}
+
+			inline WORK& at(std::size_t line, std::size_t column) {
+				return vals_[line * columns_ + column];
+			}
+
+			inline std::vector<std::size_t> const& pivots() const {
+				return pivots_;
+			}
+
+			inline WORK pivot() const {
+				return pivot_;
+			}
+
+			inline bool odd() const {
+				return odd_;
+			}
+
+			void reduce(std::size_t last_column, bool above) {
+				/*
+				eliminates the columns before last_column
+				above == false : echelon form (Bareiss), the last pivot is the determinant for a square matrix
+				above == true : reduced echelon form, each pivot line is pivot() times the line of the rref
+				*/
+				WORK previous = 1;
+				std::size_t line = 0;
+				for (std::size_t column = 0; column < last_column && line < lines_; column++) {
+					std::size_t found = line;
+					while (found < lines_ && at(found, column) == 0) {
+						found++;
+					}
+					if (found == lines_) {
+						continue;
+					}
+					if (found != line) {
+						std::swap_ranges(vals_.begin() + found * columns_, vals_.begin() + (found + 1u) * columns_, vals_.begin() + line * columns_);
+						odd_ = !odd_;
+					}
+					const WORK pivot = at(line, column);
+					for (std::size_t i = above ? 0u : line + 1u; i < lines_; i++) {
+						if (i == line) {
+							continue;
+						}
+						const WORK factor = at(i, column);
+						for (std::size_t j = 0; j < columns_; j++) {
+							if (j != column) {
+								at(i, j) = exact_step(pivot, at(i, j), factor, at(line, j), previous);
+							}
+						}
+						at(i, column) = 0;
+					}
+					previous = pivot;
+					pivots_.push_back(column);
+					line++;
+				}
+				pivot_ = previous;
+			}
+		};
+
+		template<typename INTEGER, typename WORK>
+		FractionFree<WORK> fraction_free(Matrix2D<INTEGER> const& matrix, std::vector<INTEGER> const* b, std::vector<WORK>&) {
+			FractionFree<WORK> result(matrix.lines(), matrix.columns() + (b != nullptr ? 1u : 0u));
+			for (std::size_t i = 0; i < matrix.lines(); i++) {
+				for (std::size_t j = 0; j < matrix.columns(); j++) {
+					result.at(i, j) = static_cast<WORK>(matrix.value(i, j));
+				}
+				if (b != nullptr) {
+					result.at(i, matrix.columns()) = static_cast<WORK>((*b)[i]);
+				}
+			}
+			return result;
+		}
+
+		template<typename INTEGER, typename WORK>
+		FractionFree<WORK> fraction_free(Matrix2D<Frac<INTEGER>> const& matrix, std::vector<Frac<INTEGER>> const* b, std::vector<WORK>& scales) {
+			// each line (with its value of b) is multiplied by the lcm of its denominators, kept in scales
+			const std::size_t columns = matrix.columns() + (b != nullptr ? 1u : 0u);
+			FractionFree<WORK> result(matrix.lines(), columns);
+			scales.assign(matrix.lines(), 1);
+			for (std::size_t i = 0; i < matrix.lines(); i++) {
+				auto cell = [&](std::size_t j) -> Frac<INTEGER> const& {
+					return j < matrix.columns() ? matrix.value(i, j) : (*b)[i];
+				};
+				WORK lcm = 1;
+				for (std::size_t j = 0; j < columns; j++) {
+					const WORK denominator = exact_abs(static_cast<WORK>(cell(j).denominator()));
+					lcm = exact_multiply(lcm / exact_gcd(lcm, denominator), denominator);
+				}
+				for (std::size_t j = 0; j < columns; j++) {
+					result.at(i, j) = exact_multiply(static_cast<WORK>(cell(j).numerator()), lcm / static_cast<WORK>(cell(j).denominator()));
+				}
+				scales[i] = lcm;
+			}
+			return result;
+		}
+
+		template<typename INTEGER, typename WORK>
+		Frac<INTEGER> exact_frac(WORK numerator, WORK denominator, std::string const& func_name) {
+			// reduced in WORK before the conversion => fits more often
+			const WORK divisor = exact_gcd(numerator, denominator);
+			if (divisor != 0) {
+				numerator /= divisor;
+				denominator /= divisor;
+			}
+			if (denominator < 0) {
+				numerator = -numerator;
+				denominator = -denominator;
+			}
+			if (numerator == 0 || denominator == 1) {
+				return Frac<INTEGER>(exact_narrow<INTEGER>(numerator, func_name));
+			}
+			return Frac<INTEGER>(exact_narrow<INTEGER>(numerator, func_name), exact_narrow<INTEGER>(denominator, func_name));
+		}
+
+		template<typename T>
+		struct exact_integer { // integer type of the values of a Matrix2D<T>
+			typedef T type;
+		};
+
+		template<typename INTEGER>
+		struct exact_integer<Frac<INTEGER>> {
+			typedef INTEGER type;
+		};
+	}
+
+	template<typename T>
+	Frac<typename detail::exact_integer<T>::type> exact_determinant(Matrix2D<T> const& matrix) {
+		typedef typename detail::exact_integer<T>::type INTEGER;
+		typedef typename detail::exact_work<INTEGER>::type WORK;
+		static_assert(detail::exact_integral<INTEGER>::value, "math::exact_determinant : integer or Frac<integer> values only");
+		if (matrix.lines() != matrix.columns()) {
+			error("math::exact_determinant", "the matrix must be square");
+		}
+		if (matrix.lines() == 0u) {
+			return Frac<INTEGER>(static_cast<INTEGER>(1));
+		}
+		std::vector<WORK> scales;
+		detail::FractionFree<WORK> elimination = detail::fraction_free(matrix, static_cast<std::vector<T> const*>(nullptr), scales);
+		elimination.reduce(matrix.columns(), false);
+		if (elimination.pivots().size() != matrix.lines()) {
+			return Frac<INTEGER>(static_cast<INTEGER>(0));
+		}
+		WORK numerator = elimination.odd() ? -elimination.pivot() : elimination.pivot();
+		WORK denominator = 1;
+		for (WORK scale : scales) { // det(a) = det(scaled a) / product of the scales, reduced as it goes
+			const WORK divisor = detail::exact_gcd(numerator, scale);
+			numerator /= divisor;
+			denominator = detail::exact_multiply(denominator, scale / divisor);
+		}
+		return detail::exact_frac<INTEGER>(numerator, denominator, "math::exact_determinant");
+	}
+
+	template<typename T>
+	std::size_t exact_rank(Matrix2D<T> const& matrix) {
+		typedef typename detail::exact_integer<T>::type INTEGER;
+		typedef typename detail::exact_work<INTEGER>::type WORK;
+		static_assert(detail::exact_integral<INTEGER>::value, "math::exact_rank : integer or Frac<integer> values only");
+		std::vector<WORK> scales;
+		detail::FractionFree<WORK> elimination = detail::fraction_free(matrix, static_cast<std::vector<T> const*>(nullptr), scales);
+		elimination.reduce(matrix.columns(), false);
+		return elimination.pivots().size();
+	}
+
+	template<typename T>
+	Matrix2D<Frac<typename detail::exact_integer<T>::type>> rref(Matrix2D<T> const& matrix) {
+		// reduced row echelon form
+		typedef typename detail::exact_integer<T>::type INTEGER;
+		typedef typename detail::exact_work<INTEGER>::type WORK;
+		static_assert(detail::exact_integral<INTEGER>::value, "math::rref : integer or Frac<integer> values only");
+		std::vector<WORK> scales;
+		detail::FractionFree<WORK> elimination = detail::fraction_free(matrix, static_cast<std::vector<T> const*>(nullptr), scales);
+		elimination.reduce(matrix.columns(), true);
+		Matrix2D<Frac<INTEGER>> result(matrix.lines(), matrix.columns());
+		const std::size_t rank = elimination.pivots().size();
+		for (std::size_t i = 0; i < matrix.lines(); i++) {
+			for (std::size_t j = 0; j < matrix.columns(); j++) {
+				result[i][j] = i < rank ? detail::exact_frac<INTEGER>(elimination.at(i, j), elimination.pivot(), "math::rref") : Frac<INTEGER>(static_cast<INTEGER>(0));
+			}
+		}
+		return result;
+	}
+
+	template<typename T>
+	std::vector<Frac<typename detail::exact_integer<T>::type>> exact_solve(Matrix2D<T> const& a, std::vector<T> const& b) {
+		// a solution of a * x = b (the free variables are 0), error if there isn't any
+		typedef typename detail::exact_integer<T>::type INTEGER;
+		typedef typename detail::exact_work<INTEGER>::type WORK;
+		static_assert(detail::exact_integral<INTEGER>::value, "math::exact_solve : integer or Frac<integer> values only");
+		if (b.size() != a.lines()) {
+			error("math::exact_solve", "b.size() (" + std::to_string(b.size()) + ") != a.lines() (" + std::to_string(a.lines()) + ")");
+		}
+		std::vector<WORK> scales;
+		detail::FractionFree<WORK> elimination = detail::fraction_free(a, &b, scales);
+		elimination.reduce(a.columns(), true);
+		std::vector<std::size_t> const& pivots = elimination.pivots();
+		for (std::size_t i = pivots.size(); i < a.lines(); i++) {
+			if (elimination.at(i, a.columns()) != 0) {
+				error("math::exact_solve", "the system doesn't have any solution");
+			}
+		}
+		std::vector<Frac<INTEGER>> result(a.columns(), Frac<INTEGER>(static_cast<INTEGER>(0)));
+		for (std::size_t i = 0; i < pivots.size(); i++) {
+			result[pivots[i]] = detail::exact_frac<INTEGER>(elimination.at(i, a.columns()), elimination.pivot(), "math::exact_solve");
+		}
+		return result;
+	}
+}
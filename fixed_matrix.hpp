@@ -0,0 +1,339 @@
+#pragma once
+
+#include "include.hpp"
+#include "matrix.hpp"
+#include <utility>
+#include <type_traits>
+
+/*
+math::Matrix<NUMBER, LINES, COLUMNS> : matrix with its size known at compile time
+values are stored in the object itself (no allocation), every loop is unrolled and everything is constexpr :
+	constexpr math::Matrix<double, 2, 2> rotation = { { 0., -1. }, { 1., 0. } };
+	constexpr double det = rotation.determinant(); // computed by the compiler
+made for small matrices (up to ~8x8), use math::Matrix2D for the big ones
+*/
+
+namespace math {
+
+	namespace detail {
+
+		template<typename FUNCTION, std::size_t... I>
+		constexpr void unroll(FUNCTION&& function, std::index_sequence<I...>) {
+			(function(I), ...);
+		}
+
+		template<std::size_t N, typename FUNCTION>
+		constexpr void unroll(FUNCTION&& function) {
+			// function(0), function(1), ..., function(N - 1) without any loop
+			detail::unroll(function, std::make_index_sequence<N>());
+		}
+
+		template<typename NUMBER>
+		constexpr NUMBER constexpr_abs(NUMBER value) {
+			return value < NUMBER() ? -value : value;
+		}
+	}
+
+	template<typename NUMBER, std::size_t LINES, std::size_t COLUMNS>
+	class Matrix {
+		NUMBER vals_[LINES * COLUMNS] = {};
+
+	public:
+		typedef NUMBER number_type;
+
+		constexpr Matrix() = default;
+
+		constexpr Matrix(std::initializer_list<std::initializer_list<NUMBER>> vals) {
+			// missing values are NUMBER(), extra values are an error
+			if (vals.size() > LINES) {
+				error("math::Matrix::Matrix", "too many lines");
+			}
+			std::size_t line = 0;
+			for (std::initializer_list<NUMBER> const& values : vals) {
+				if (values.size() > COLUMNS) {
+					error("math::Matrix::Matrix", "too many columns");
+				}
+				std::size_t column = 0;
+				for (NUMBER const& value : values) {
+					vals_[line * COLUMNS + column] = value;
+					column++;
+				}
+				line++;
+			}
+		}
+
+		Matrix(Matrix2D<NUMBER> const& matrix) {
+			if (matrix.lines() != LINES || matrix.columns() != COLUMNS) {
+				error("math::Matrix::Matrix", "Matrix2D is " + std::to_string(matrix.lines()) + "x" + std::to_string(matrix.columns()) + ", expected " + std::to_string(LINES) + "x" + std::to_string(COLUMNS));
+			}
+			for (std::size_t line = 0; line < LINES; line++) {
+				std::copy(matrix.data() + line * matrix.stride(), matrix.data() + line * matrix.stride() + COLUMNS, vals_ + line * COLUMNS);
+			}
+		}
+
+		Matrix2D<NUMBER> to_matrix2d() const {
+			Matrix2D<NUMBER> result(LINES, COLUMNS);
+			NUMBER* values = result.data();
+			for (std::size_t line = 0; line < LINES; line++) {
+				std::copy(vals_ + line * COLUMNS, vals_ + (line + 1u) * COLUMNS, values + line * result.stride());
+			}
+			return result;
+		}
+
+		static constexpr Matrix identity() {
+			static_assert(LINES == COLUMNS, "math::Matrix::identity : the matrix must be square");
+			Matrix result;
+			detail::unroll<LINES>([&](std::size_t i) { result.vals_[i * COLUMNS + i] = static_cast<NUMBER>(1); });
+			return result;
+		}
+
+		static constexpr std::size_t lines() {
+			return LINES;
+		}
+
+		static constexpr std::size_t columns() {
+			return COLUMNS;
+		}
+
+		constexpr NUMBER* operator[](std::size_t line) { // m[line][column], no bounds checking
+			return vals_ + line * COLUMNS;
+		}
+
+		constexpr NUMBER const* operator[](std::size_t line) const {
+			return vals_ + line * COLUMNS;
+		}
+
+		constexpr NUMBER& operator()(std::size_t line, std::size_t column) {
+			return vals_[line * COLUMNS + column];
+		}
+
+		constexpr NUMBER const& operator()(std::size_t line, std::size_t column) const {
+			return vals_[line * COLUMNS + column];
+		}
+
+		constexpr NUMBER* data() {
+			return vals_;
+		}
+
+		constexpr NUMBER const* data() const {
+			return vals_;
+		}
+
+		constexpr Matrix operator+(Matrix const& matrix) const {
+			Matrix result;
+			detail::unroll<LINES * COLUMNS>([&](std::size_t i) { result.vals_[i] = vals_[i] + matrix.vals_[i]; });
+			return result;
+		}
+
+		constexpr Matrix operator-(Matrix const& matrix) const {
+			Matrix result;
+			detail::unroll<LINES * COLUMNS>([&](std::size_t i) { result.vals_[i] = vals_[i] - matrix.vals_[i]; });
+			return result;
+		}
+
+		constexpr Matrix operator-() const {
+			Matrix result;
+			detail::unroll<LINES * COLUMNS>([&](std::size_t i) { result.vals_[i] = -vals_[i]; });
+			return result;
+		}
+
+		constexpr Matrix operator*(NUMBER factor) const {
+			Matrix result;
+			detail::unroll<LINES * COLUMNS>([&](std::size_t i) { result.vals_[i] = vals_[i] * factor; });
+			return result;
+		}
+
+		template<std::size_t K>
+		constexpr Matrix<NUMBER, LINES, K> operator*(Matrix<NUMBER, COLUMNS, K> const& matrix) const {
+			Matrix<NUMBER, LINES, K> result;
+			detail::unroll<LINES * K>([&](std::size_t index) {
+				const std::size_t line = index / K;
+				const std::size_t column = index % K;
+				NUMBER sum = NUMBER();
+				detail::unroll<COLUMNS>([&](std::size_t p) { sum += vals_[line * COLUMNS + p] * matrix(p, column); });
+				result(line, column) = sum;
+			});
+			return result;
+		}
+
+		constexpr bool operator==(Matrix const& matrix) const {
+			for (std::size_t i = 0; i < LINES * COLUMNS; i++) {
+				if (!(vals_[i] == matrix.vals_[i])) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		constexpr bool operator!=(Matrix const& matrix) const {
+			return !(*this == matrix);
+		}
+
+		constexpr Matrix<NUMBER, COLUMNS, LINES> transpose() const {
+			Matrix<NUMBER, COLUMNS, LINES> result;
+			detail::unroll<LINES * COLUMNS>([&](std::size_t i) { result(i % COLUMNS, i / COLUMNS) = vals_[i]; });
+			return result;
+		}
+
+		constexpr NUMBER determinant() const {
+			static_assert(LINES == COLUMNS, "math::Matrix::determinant : the matrix must be square");
+			constexpr std::size_t N = LINES;
+			if constexpr (N == 0u) {
+				return static_cast<NUMBER>(1);
+			}
+			else if constexpr (N == 1u) {
+				return vals_[0];
+			}
+			else if constexpr (N == 2u) {
+				return vals_[0] * vals_[3] - vals_[1] * vals_[2];
+			}
+			else if constexpr (N == 3u) {
+				return vals_[0] * (vals_[4] * vals_[8] - vals_[5] * vals_[7])
+					- vals_[1] * (vals_[3] * vals_[8] - vals_[5] * vals_[6])
+					+ vals_[2] * (vals_[3] * vals_[7] - vals_[4] * vals_[6]);
+			}
+			else if constexpr (std::is_integral<NUMBER>::value) {
+				// Bareiss : every division is exact, the values stay integers
+				Matrix a = *this;
+				NUMBER sign = static_cast<NUMBER>(1);
+				NUMBER previous = static_cast<NUMBER>(1);
+				for (std::size_t k = 0; k + 1u < N; k++) {
+					if (a(k, k) == NUMBER()) {
+						std::size_t pivot = k + 1u;
+						while (pivot < N && a(pivot, k) == NUMBER()) {
+							pivot++;
+						}
+						if (pivot == N) {
+							return NUMBER();
+						}
+						a.swap_lines(k, pivot);
+						sign = -sign;
+					}
+					for (std::size_t i = k + 1u; i < N; i++) {
+						for (std::size_t j = k + 1u; j < N; j++) {
+							a(i, j) = (a(i, j) * a(k, k) - a(i, k) * a(k, j)) / previous;
+						}
+					}
+					previous = a(k, k);
+				}
+				return sign * a(N - 1u, N - 1u);
+			}
+			else {
+				// gaussian elimination with partial pivoting
+				Matrix a = *this;
+				NUMBER result = static_cast<NUMBER>(1);
+				for (std::size_t k = 0; k < N; k++) {
+					const std::size_t pivot = a.pivot(k);
+					if (a(pivot, k) == NUMBER()) {
+						return NUMBER();
+					}
+					if (pivot != k) {
+						a.swap_lines(k, pivot);
+						result = -result;
+					}
+					result *= a(k, k);
+					for (std::size_t i = k + 1u; i < N; i++) {
+						const NUMBER factor = a(i, k) / a(k, k);
+						for (std::size_t j = k + 1u; j < N; j++) {
+							a(i, j) -= factor * a(k, j);
+						}
+					}
+				}
+				return result;
+			}
+		}
+
+		constexpr Matrix inverse() const {
+			static_assert(LINES == COLUMNS, "math::Matrix::inverse : the matrix must be square");
+			constexpr std::size_t N = LINES;
+			if constexpr (N == 2u) {
+				const NUMBER det = determinant();
+				if (det == NUMBER()) {
+					error("math::Matrix::inverse", "the matrix is singular");
+				}
+				return Matrix({ { vals_[3] / det, -vals_[1] / det }, { -vals_[2] / det, vals_[0] / det } });
+			}
+			else if constexpr (N == 3u) { // adjugate / determinant
+				const NUMBER det = determinant();
+				if (det == NUMBER()) {
+					error("math::Matrix::inverse", "the matrix is singular");
+				}
+				Matrix result;
+				detail::unroll<9u>([&](std::size_t index) {
+					const std::size_t i = index / 3u;
+					const std::size_t j = index % 3u;
+					// cofactor of (j, i), the indexes modulo 3 give the sign for free
+					const std::size_t l0 = (j + 1u) % 3u, l1 = (j + 2u) % 3u, c0 = (i + 1u) % 3u, c1 = (i + 2u) % 3u;
+					result.vals_[index] = (vals_[l0 * 3u + c0] * vals_[l1 * 3u + c1] - vals_[l0 * 3u + c1] * vals_[l1 * 3u + c0]) / det;
+				});
+				return result;
+			}
+			else { // gauss-jordan with partial pivoting
+				Matrix a = *this;
+				Matrix result = identity();
+				for (std::size_t k = 0; k < N; k++) {
+					const std::size_t pivot = a.pivot(k);
+					if (a(pivot, k) == NUMBER()) {
+						error("math::Matrix::inverse", "the matrix is singular");
+					}
+					a.swap_lines(k, pivot);
+					result.swap_lines(k, pivot);
+					const NUMBER factor = a(k, k);
+					detail::unroll<N>([&](std::size_t j) {
+						a(k, j) /= factor;
+						result(k, j) /= factor;
+					});
+					for (std::size_t i = 0; i < N; i++) {
+						if (i != k) {
+							const NUMBER coefficient = a(i, k);
+							detail::unroll<N>([&](std::size_t j) {
+								a(i, j) -= coefficient * a(k, j);
+								result(i, j) -= coefficient * result(k, j);
+							});
+						}
+					}
+				}
+				return result;
+			}
+		}
+
+		constexpr void swap_lines(std::size_t first_line, std::size_t second_line) {
+			if (first_line != second_line) {
+				detail::unroll<COLUMNS>([&](std::size_t j) {
+					const NUMBER tmp = vals_[first_line * COLUMNS + j];
+					vals_[first_line * COLUMNS + j] = vals_[second_line * COLUMNS + j];
+					vals_[second_line * COLUMNS + j] = tmp;
+				});
+			}
+		}
+
+	private:
+		constexpr std::size_t pivot(std::size_t column) const {
+			// line >= column with the biggest absolute value in the column
+			std::size_t result = column;
+			for (std::size_t line = column + 1u; line < LINES; line++) {
+				if (detail::constexpr_abs((*this)(result, column)) < detail::constexpr_abs((*this)(line, column))) {
+					result = line;
+				}
+			}
+			return result;
+		}
+	};
+
+	template<typename NUMBER, std::size_t LINES, std::size_t COLUMNS>
+	constexpr Matrix<NUMBER, LINES, COLUMNS> operator*(NUMBER factor, Matrix<NUMBER, LINES, COLUMNS> const& matrix) {
+		return matrix * factor;
+	}
+
+	typedef math::Matrix<float, 2, 2> FMatrix2x2;
+	typedef math::Matrix<float, 3, 3> FMatrix3x3;
+	typedef math::Matrix<float, 4, 4> FMatrix4x4;
+	typedef math::Matrix<double, 2, 2> DMatrix2x2;
+	typedef math::Matrix<double, 3, 3> DMatrix3x3;
+	typedef math::Matrix<double, 4, 4> DMatrix4x4;
+}
+
+template<typename NUMBER, std::size_t LINES, std::size_t COLUMNS>
+std::ostream& operator<<(std::ostream& stream, math::Matrix<NUMBER, LINES, COLUMNS> const& matrix) {
+	return stream << matrix.to_matrix2d();
+}
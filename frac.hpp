@@ -1,242 +1,776 @@
-#pragma once
-
-#include "include.hpp"
-#include "utils.hpp"
-#include "prime.hpp"
-
-enum class frac_mode { FRAC, NUMBER };
-
-namespace math {
-
-	template<typename NUMBER>
-	class Frac {
-		NUMBER numerator_ = static_cast<NUMBER>(1);
-		NUMBER denominator_ = static_cast<NUMBER>(1);
-		mutable frac_mode output_ = frac_mode::FRAC;
-
-		void reduce() {
-			std::vector<long long int> factors_numerator = math::prime_factors(static_cast<long long int>(numerator_));
-			std::vector<long long int> factors_denominator = math::prime_factors(static_cast<long long int>(denominator_));
-			for (std::size_t i = 0; i < factors_numerator.size(); i++) {
-				for (std::size_t j = 0; j < factors_denominator.size(); j++) {
-					if (factors_numerator[i] == factors_denominator[j]) {
-						factors_numerator.erase(factors_numerator.begin() + i);
-						factors_denominator.erase(factors_denominator.begin() + j);
-					}
-				}
-			}
-			numerator_ = static_cast<NUMBER>(std::accumulate(factors_numerator.begin(), factors_numerator.end(), 1, std::multiplies<long long int>()));
-			denominator_ = static_cast<NUMBER>(std::accumulate(factors_denominator.begin(), factors_denominator.end(), 1, std::multiplies<long long int>()));
-		}
-
-	public:
-
-		Frac(NUMBER numerator, NUMBER denominator) {
-			numerator_ = numerator;
-			if (denominator == 0) {
-				error("math::Frac::Frac", "denominator cannot be 0 !");
-			}
-			denominator_ = denominator;
-			reduce();
-		}
-
-		Frac(NUMBER result) {
-			numerator_ = result;
-		}
-
-		Frac() = default;
-
-		inline NUMBER result() const {
-			return numerator_ / denominator_;
-		}
-
-		inline NUMBER numerator() const {
-			return numerator_;
-		}
-
-		inline NUMBER denominator() const {
-			return denominator_;
-		}
-
-		inline void numerator(NUMBER new_numerator) {
-			numerator_ = new_numerator;
-		}
-
-		inline void denominator(NUMBER new_denominator) {
-			if (new_denominator == 0) {
-				error("math::Frac::denominator", "denominator cannot be 0 !");
-			}
-			denominator_ = new_denominator;
-			reduce();
-		}
-
-		inline frac_mode output_mode() const {
-			return output_;
-		}
-
-		inline void output_mode(frac_mode mode) const {
-			output_ = mode;
-		}
-
-		template<typename T>
-		inline Frac<NUMBER> operator+(Frac<T> const& frac) const {
-			return Frac<NUMBER>(numerator_ * frac.denominator() + frac.numerator() * denominator_, denominator_ * frac.denominator());
-		}
-
-		inline Frac<NUMBER> operator+(NUMBER n) const {
-			return Frac<NUMBER>(numerator_ + n * denominator_, denominator_);
-		}
-
-		inline void operator++() {		// ++Frac
-			numerator_ += denominator_;
-			reduce();
-		}
-
-		inline void operator++(int) { // Frac++
-			++(*this);
-		}
-
-		template<typename T>
-		inline Frac<NUMBER> operator-(Frac<T> const& frac) const {
-			return Frac<NUMBER>(numerator_ * frac.denominator() - frac.numerator() * denominator_, denominator_ * frac.denominator());
-		}
-
-		inline Frac<NUMBER> operator-(NUMBER n) const {
-			return Frac<NUMBER>(numerator_ - n * denominator_, denominator_);
-		}
-
-		inline void operator--() {		// ++Frac
-			numerator_ -= denominator_;
-			reduce();
-		}
-
-		inline void operator--(int) { // Frac++
-			--(*this);
-		}
-
-		template<typename T>
-		inline Frac<NUMBER> operator*(Frac<T> const& frac) {
-			return Frac<NUMBER>(numerator_ * frac.numerator(), denominator_ * frac.denominator());
-		}
-
-		inline Frac<NUMBER> operator*(NUMBER number) {
-			return Frac<NUMBER>(numerator_ * number, denominator_);
-		}
-
-		template<typename T>
-		inline Frac<NUMBER> operator/(Frac<T> const& frac) {
-			return Frac<NUMBER>(numerator_ * frac.denominator(), denominator_ * frac.numerator());
-		}
-
-		inline Frac<NUMBER> operator/(NUMBER number) {
-			return Frac<NUMBER>(numerator_, denominator_ * number);
-		}
-
-	};
-
-	typedef math::Frac<int> IFrac;
-	typedef math::Frac<float> FFrac;
-	typedef math::Frac<long long int> LIFrac;
-	typedef math::Frac<long double> LFFrac;
-}
-
-inline math::IFrac operator"" _ifrac(const char* expr, std::size_t length) {
-	// ex : Frac f = "3/2"_frac; <=> Frac f = Frac(3, 2)
-	const std::size_t pos = std::string(expr).find('/');
-	try {
-		return math::IFrac(std::stoi(std::string(expr).substr(0, pos)), std::stoi(std::string(expr).substr(pos + 1)));
-	}
-	catch (std::invalid_argument&) {
-		error("operator\"\" _ifrac", "invalid frac expression : " + std::string(expr));
-	}
-}
-
-inline math::FFrac operator"" _ffrac(const char* expr, std::size_t length) {
-	// ex : Frac f = "3/2"_frac; <=> Frac f = Frac(3, 2)
-	const std::size_t pos = std::string(expr).find('/');
-	try {
-		return math::FFrac(std::stof(std::string(expr).substr(0, pos)), std::stof(std::string(expr).substr(pos + 1)));
-	}
-	catch (std::invalid_argument&) {
-		error("operator\"\" _ffrac", "invalid frac expression : " + std::string(expr));
-	}
-}
-
-inline math::LIFrac operator"" _lifrac(const char* expr, std::size_t length) {
-	// ex : Frac f = "3/2"_frac; <=> Frac f = Frac(3, 2)
-	const std::size_t pos = std::string(expr).find('/');
-	try {
-		return math::LIFrac(std::stol(std::string(expr).substr(0, pos)), std::stol(std::string(expr).substr(pos + 1)));
-	}
-	catch (std::invalid_argument&) {
-		error("operator\"\" _lifrac", "invalid frac expression : " + std::string(expr));
-	}
-}
-
-inline math::LFFrac operator"" _lffrac(const char* expr, std::size_t length) {
-	// ex : Frac f = "3/2"_frac; <=> Frac f = Frac(3, 2)
-	const std::size_t pos = std::string(expr).find('/');
-	try {
-		return math::LFFrac(std::stold(std::string(expr).substr(0, pos)), std::stold(std::string(expr).substr(pos + 1)));
-	}
-	catch (std::invalid_argument&) {
-		error("operator\"\" _lffrac", "invalid frac expression : " + std::string(expr));
-	}
-}
-
-inline math::IFrac operator"" _ifrac(long double result) {
-	return math::IFrac(static_cast<int>(result));
-}
-
-inline math::FFrac operator"" _ffrac(long double result) {
-	return math::FFrac(static_cast<float>(result));
-}
-
-inline math::LIFrac operator"" _lifrac(long double result) {
-	return math::LIFrac(static_cast<long long int>(result));
-}
-
-inline math::LFFrac operator"" _lffrac(long double result) {
-	return math::LFFrac(result);
-}
-
-template<typename NUMBER>
-inline std::ostream& operator<<(std::ostream& stream, math::Frac<NUMBER> const& frac) {
-	if (frac.output_mode() == frac_mode::FRAC) {
-		stream << frac.numerator() << std::endl;
-		const std::size_t size = std::max(math::reduce_number(std::to_string(frac.numerator())).size(), math::reduce_number(std::to_string((frac.denominator()))).size());
-		// fraction bar's length
-		for (std::size_t i = 0; i < size; i++) {
-			stream << '-';
-		}
-		return stream << std::endl << frac.denominator();
-	}
-	return stream << (frac.numerator() / frac.denominator());
-}
-
-template<typename NUMBER>
-inline std::istream& operator>>(std::istream& stream, math::Frac<NUMBER>& frac) {
-	std::string expr;
-	std::cin >> expr;
-	const std::size_t pos = std::string(expr).find('/');
-	if (std::find(expr.begin(), expr.end(), '/') == expr.end()) {
-		frac = math::Frac<NUMBER>(std::stold(expr));
-		return stream;
-	}
-	else {
-		try {
-			frac = math::Frac<NUMBER>(std::stold(std::string(expr).substr(0, pos)), std::stold(std::string(expr).substr(pos + 1)));
-			return stream;
-		}
-		catch (std::invalid_argument& cast_error) {
-			error("operator>> math::Frac", "invalid frac expression : " + std::string(expr));
-		}
-	}
-}
-
-#ifndef DISABLE_FRAC_TYPES
-// to be used in main
-
-constexpr frac_mode FRAC = frac_mode::FRAC;
-constexpr frac_mode NUMBER = frac_mode::NUMBER;
+#pragma once
+
+#include "include.hpp"
+#include "utils.hpp"
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <type_traits>
+
+#if __cplusplus > 201703L && defined(__cpp_impl_three_way_comparison)
+#include <compare>
+#define MATH_FRAC_THREE_WAY
+#endif
+
+enum class frac_mode { FRAC, NUMBER };
+
+/*
+math::Frac is always kept reduced (gcd(numerator, denominator) == 1, denominator > 0) with math::detail::binary_gcd
+define ENABLE_LAZY_FRAC to skip the reduction after each operation : numerator() and denominator() still return the reduced values
+(computed when they are called), normalize() reduces the stored values
+=> chains of + and * are cheaper but the stored values grow until normalize(), watch out for overflows
+the operations are computed on a wider integer (long long for int, __int128 for long long) and reduced before going back
+=> no overflow as long as the reduced result fits, define ENABLE_FRAC_OVERFLOW_CHECK to get an error when it doesn't
+math::Frac<math::BigInt> (bigint.hpp) never overflows
+math::Frac of an integer type is a literal type : arithmetic, comparisons and the _ifrac / _lifrac literals work in constant expressions
+*/
+
+namespace math {
+	class BigInt;
+}
+
+// defined in bigint.hpp, declared here so the operator<< of Frac (a template of the global namespace) can print a Frac<BigInt>
+inline std::ostream& operator<<(std::ostream& stream, math::BigInt const& number);
+
+namespace math {
+
+	namespace detail {
+
+		template<typename INTEGER>
+		struct unsigned_type { // std::make_unsigned, also for __int128
+			typedef typename std::make_unsigned<INTEGER>::type type;
+		};
+
+		template<typename INTEGER>
+		struct wide_type { // cross products of two INTEGER fit in it
+			typedef INTEGER type;
+		};
+
+		template<>
+		struct wide_type<int> {
+			typedef long long int type;
+		};
+
+#ifdef __SIZEOF_INT128__
+		template<>
+		struct unsigned_type<__int128> {
+			typedef unsigned __int128 type;
+		};
+
+		template<>
+		struct unsigned_type<unsigned __int128> {
+			typedef unsigned __int128 type;
+		};
+
+		template<>
+		struct wide_type<long int> {
+			typedef typename std::conditional<sizeof(long int) == sizeof(int), long long int, __int128>::type type;
+		};
+
+		template<>
+		struct wide_type<long long int> {
+			typedef __int128 type;
+		};
+#endif
+
+		template<typename UNSIGNED>
+		constexpr int trailing_zeros(UNSIGNED value) { // value != 0
+#if defined(__GNUC__)
+			if constexpr (sizeof(UNSIGNED) <= sizeof(unsigned int)) {
+				return __builtin_ctz(static_cast<unsigned int>(value));
+			}
+			else if constexpr (sizeof(UNSIGNED) <= sizeof(unsigned long int)) {
+				return __builtin_ctzl(static_cast<unsigned long int>(value));
+			}
+			else if constexpr (sizeof(UNSIGNED) <= sizeof(unsigned long long int)) {
+				return __builtin_ctzll(static_cast<unsigned long long int>(value));
+			}
+			else { // 128 bits
+				const unsigned long long int low = static_cast<unsigned long long int>(value);
+				return low != 0u ? __builtin_ctzll(low) : 64 + __builtin_ctzll(static_cast<unsigned long long int>(value >> 64));
+			}
+#else
+			int result = 0;
+			for (; (value & 1u) == 0u; value >>= 1) {
+				result++;
+			}
+			return result;
+#endif
+		}
+
+		template<typename INTEGER>
+		constexpr typename unsigned_type<INTEGER>::type unsigned_abs(INTEGER value) {
+			typedef typename unsigned_type<INTEGER>::type UNSIGNED;
+			if (value < static_cast<INTEGER>(0)) {
+				return static_cast<UNSIGNED>(UNSIGNED(0) - static_cast<UNSIGNED>(value));
+			}
+			return static_cast<UNSIGNED>(value);
+		}
+
+		template<typename INTEGER>
+		constexpr typename unsigned_type<INTEGER>::type binary_gcd(INTEGER a, INTEGER b) {
+			// Stein's algorithm : shifts and subtractions only, gcd(|a|, |b|), gcd(0, b) = |b|, usable at compile time
+			typedef typename unsigned_type<INTEGER>::type UNSIGNED;
+			UNSIGNED u = detail::unsigned_abs(a);
+			UNSIGNED v = detail::unsigned_abs(b);
+			if (u == 0u || v == 0u) {
+				return u | v;
+			}
+			const int shift = detail::trailing_zeros(static_cast<UNSIGNED>(u | v));
+			u >>= detail::trailing_zeros(u);
+			do {
+				v >>= detail::trailing_zeros(v);
+				if (u > v) { // std::swap isn't constexpr before C++20
+					const UNSIGNED t = u;
+					u = v;
+					v = t;
+				}
+				v -= u;
+			} while (v != 0u);
+			return static_cast<UNSIGNED>(u << shift);
+		}
+
+		constexpr std::uint64_t hash_mix(std::uint64_t value) { // splitmix64 finalizer, every bit of value changes half of the bits
+			value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+			value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+			return value ^ (value >> 31);
+		}
+
+		constexpr std::size_t hash_combine(std::size_t seed, std::size_t value) {
+			return static_cast<std::size_t>(hash_mix(seed * 0x9E3779B97F4A7C15ull + value));
+		}
+
+		template<typename NUMBER>
+		inline std::string frac_text(NUMBER const& value) { // same text as operator<<
+			if constexpr (std::is_arithmetic<NUMBER>::value) {
+				return math::reduce_number(std::to_string(value));
+			}
+			else {
+				std::ostringstream stream;
+				stream << value;
+				return stream.str();
+			}
+		}
+	}
+
+	template<typename NUMBER>
+	class Frac {
+		NUMBER numerator_ = static_cast<NUMBER>(1);
+		NUMBER denominator_ = static_cast<NUMBER>(1);
+		frac_mode output_ = frac_mode::FRAC; // not mutable : a constexpr Frac couldn't be copied
+
+		template<typename T>
+		friend class Frac;
+
+		constexpr void reduce() {
+			// no allocation, O(log(max(numerator, denominator))), constexpr for the integer types
+			if (denominator_ < 0) {
+				numerator_ = -numerator_;
+				denominator_ = -denominator_;
+			}
+			if constexpr (std::is_floating_point<NUMBER>::value) {
+				// only whole values that fit in a long long can be reduced
+				constexpr NUMBER limit = static_cast<NUMBER>(1ll << 62);
+				if (std::trunc(numerator_) == numerator_ && std::trunc(denominator_) == denominator_ && std::abs(numerator_) < limit && denominator_ < limit) {
+					const long long int divisor = static_cast<long long int>(detail::binary_gcd(static_cast<long long int>(numerator_), static_cast<long long int>(denominator_)));
+					if (divisor > 1) {
+						numerator_ /= static_cast<NUMBER>(divisor);
+						denominator_ /= static_cast<NUMBER>(divisor);
+					}
+				}
+			}
+			else if constexpr (std::is_class<NUMBER>::value) { // big integers, gcd found by ADL (math::gcd for math::BigInt)
+				const NUMBER divisor = gcd(numerator_, denominator_);
+				if (divisor > 1) {
+					numerator_ /= divisor;
+					denominator_ /= divisor;
+				}
+			}
+			else {
+				const NUMBER divisor = static_cast<NUMBER>(detail::binary_gcd(numerator_, denominator_));
+				if (divisor > 1) {
+					numerator_ /= divisor;
+					denominator_ /= divisor;
+				}
+			}
+		}
+
+		typedef typename detail::wide_type<NUMBER>::type wide_type;
+
+		static constexpr wide_type wide(NUMBER value) {
+			return static_cast<wide_type>(value);
+		}
+
+		static constexpr bool fits(wide_type value) {
+			return value >= static_cast<wide_type>(std::numeric_limits<NUMBER>::lowest()) && value <= static_cast<wide_type>(std::numeric_limits<NUMBER>::max());
+		}
+
+		static constexpr Frac make(wide_type numerator, wide_type denominator) {
+			/*
+			result of an operation, computed on wide_type (128 bits for long long, 64 for int) => the cross products can't overflow
+			reduced there before going back to NUMBER
+			with ENABLE_FRAC_OVERFLOW_CHECK, a reduced result that still doesn't fit is an error instead of being truncated
+			*/
+			if constexpr (std::is_same<wide_type, NUMBER>::value) {
+				return Frac(numerator, denominator);
+			}
+			else {
+				if (denominator == 0) {
+					error("math::Frac::Frac", "denominator cannot be 0 !");
+				}
+#ifdef ENABLE_LAZY_FRAC
+				const bool reduce_now = !fits(numerator) || !fits(denominator);
+#else
+				const bool reduce_now = true;
+#endif
+				if (reduce_now) {
+					if (denominator < 0) {
+						numerator = -numerator;
+						denominator = -denominator;
+					}
+					const wide_type divisor = static_cast<wide_type>(detail::binary_gcd(numerator, denominator));
+					if (divisor > 1) {
+						numerator /= divisor;
+						denominator /= divisor;
+					}
+				}
+#ifdef ENABLE_FRAC_OVERFLOW_CHECK
+				if (!fits(numerator) || !fits(denominator)) {
+					error("math::Frac", "overflow, the result doesn't fit in the integer type (math::Frac<math::BigInt> never overflows)");
+				}
+#endif
+				Frac result;
+				result.numerator_ = static_cast<NUMBER>(numerator);
+				result.denominator_ = static_cast<NUMBER>(denominator);
+				return result;
+			}
+		}
+
+		constexpr void update() { // after each change of the values
+#ifndef ENABLE_LAZY_FRAC
+			reduce();
+#endif
+		}
+
+		constexpr Frac reduced() const {
+			Frac result = *this;
+			result.reduce();
+			return result;
+		}
+
+	public:
+
+		constexpr Frac(NUMBER numerator, NUMBER denominator) {
+			numerator_ = numerator;
+			if (denominator == 0) {
+				error("math::Frac::Frac", "denominator cannot be 0 !");
+			}
+			denominator_ = denominator;
+			update();
+		}
+
+		constexpr Frac(NUMBER result) {
+			numerator_ = result;
+		}
+
+		Frac() = default;
+
+		constexpr NUMBER result() const {
+			return numerator_ / denominator_;
+		}
+
+		constexpr NUMBER numerator() const {
+#ifdef ENABLE_LAZY_FRAC
+			return reduced().numerator_;
+#else
+			return numerator_;
+#endif
+		}
+
+		constexpr NUMBER denominator() const {
+#ifdef ENABLE_LAZY_FRAC
+			return reduced().denominator_;
+#else
+			return denominator_;
+#endif
+		}
+
+		constexpr void numerator(NUMBER new_numerator) {
+			numerator_ = new_numerator;
+			update();
+		}
+
+		constexpr void denominator(NUMBER new_denominator) {
+			if (new_denominator == 0) {
+				error("math::Frac::denominator", "denominator cannot be 0 !");
+			}
+			denominator_ = new_denominator;
+			update();
+		}
+
+		constexpr void normalize() { // reduces the stored values, only useful with ENABLE_LAZY_FRAC
+			reduce();
+		}
+
+		constexpr frac_mode output_mode() const {
+			return output_;
+		}
+
+		constexpr void output_mode(frac_mode mode) {
+			output_ = mode;
+		}
+
+		template<typename T>
+		constexpr Frac<NUMBER> operator+(Frac<T> const& frac) const {
+			return make(wide(numerator_) * frac.denominator_ + wide(frac.numerator_) * denominator_, wide(denominator_) * frac.denominator_);
+		}
+
+		constexpr Frac<NUMBER> operator+(NUMBER n) const {
+			return make(wide(numerator_) + wide(n) * denominator_, wide(denominator_));
+		}
+
+		constexpr void operator++() {		// ++Frac
+			numerator_ += denominator_;
+		}
+
+		constexpr void operator++(int) { // Frac++
+			++(*this);
+		}
+
+		template<typename T>
+		constexpr Frac<NUMBER> operator-(Frac<T> const& frac) const {
+			return make(wide(numerator_) * frac.denominator_ - wide(frac.numerator_) * denominator_, wide(denominator_) * frac.denominator_);
+		}
+
+		constexpr Frac<NUMBER> operator-(NUMBER n) const {
+			return make(wide(numerator_) - wide(n) * denominator_, wide(denominator_));
+		}
+
+		constexpr void operator--() {		// ++Frac
+			numerator_ -= denominator_;
+		}
+
+		constexpr void operator--(int) { // Frac++
+			--(*this);
+		}
+
+		template<typename T>
+		constexpr Frac<NUMBER> operator*(Frac<T> const& frac) const {
+			return make(wide(numerator_) * frac.numerator_, wide(denominator_) * frac.denominator_);
+		}
+
+		constexpr Frac<NUMBER> operator*(NUMBER number) const {
+			return make(wide(numerator_) * number, wide(denominator_));
+		}
+
+		template<typename T>
+		constexpr Frac<NUMBER> operator/(Frac<T> const& frac) const {
+			return make(wide(numerator_) * frac.denominator_, wide(denominator_) * frac.numerator_);
+		}
+
+		constexpr Frac<NUMBER> operator/(NUMBER number) const {
+			return make(wide(numerator_), wide(denominator_) * number);
+		}
+
+		static constexpr int compare(Frac const& a, Frac const& b) {
+			// sign of a - b from the cross products on wide_type => no division, no rounding, works on unreduced values too
+			const wide_type left = wide(a.numerator_) * b.denominator_;
+			const wide_type right = wide(b.numerator_) * a.denominator_;
+			const int order = (left > right) - (left < right);
+			return (a.denominator_ < 0) != (b.denominator_ < 0) ? -order : order;
+		}
+
+		friend constexpr bool operator==(Frac const& a, Frac const& b) {
+			return compare(a, b) == 0;
+		}
+
+		friend constexpr bool operator!=(Frac const& a, Frac const& b) {
+			return compare(a, b) != 0;
+		}
+
+		friend constexpr bool operator<(Frac const& a, Frac const& b) {
+			return compare(a, b) < 0;
+		}
+
+		friend constexpr bool operator>(Frac const& a, Frac const& b) {
+			return compare(a, b) > 0;
+		}
+
+		friend constexpr bool operator<=(Frac const& a, Frac const& b) {
+			return compare(a, b) <= 0;
+		}
+
+		friend constexpr bool operator>=(Frac const& a, Frac const& b) {
+			return compare(a, b) >= 0;
+		}
+
+#ifdef MATH_FRAC_THREE_WAY
+		friend constexpr auto operator<=>(Frac const& a, Frac const& b) {
+			// strong ordering for the integer types, partial for the floating point ones (NaN)
+			if constexpr (std::is_floating_point<NUMBER>::value) {
+				const wide_type left = wide(a.numerator_) * b.denominator_;
+				const wide_type right = wide(b.numerator_) * a.denominator_;
+				return (a.denominator_ < 0) != (b.denominator_ < 0) ? right <=> left : left <=> right;
+			}
+			else {
+				return compare(a, b) <=> 0;
+			}
+		}
+#endif
+	};
+
+	typedef math::Frac<int> IFrac;
+	typedef math::Frac<float> FFrac;
+	typedef math::Frac<long long int> LIFrac;
+	typedef math::Frac<long double> LFFrac;
+
+	namespace detail {
+
+		constexpr bool is_digit(char c) {
+			return c >= '0' && c <= '9';
+		}
+
+		template<typename NUMBER>
+		constexpr char const* parse_decimal(char const* first, char const* last, NUMBER& numerator, NUMBER& denominator) {
+			/*
+			reads [+-]digits[.digits] at first, exactly : numerator / denominator (reduced for the integer types, "1.25" => 5 / 4)
+			returns the end of the number, first if there isn't any or if it doesn't fit in NUMBER
+			*/
+			if constexpr (std::is_floating_point<NUMBER>::value) {
+				denominator = NUMBER(1);
+				return math::parse_number(first, last, numerator);
+			}
+			else {
+				char const* position = first;
+				const bool negative = position != last && *position == '-';
+				if (position != last && (*position == '-' || *position == '+')) {
+					position++;
+				}
+				char const* const digits = position;
+				while (position != last && is_digit(*position)) {
+					position++;
+				}
+				char const* const digits_end = position;
+				char const* decimals = position;
+				char const* decimals_end = position;
+				if (position != last && *position == '.') {
+					decimals = ++position;
+					while (position != last && is_digit(*position)) {
+						position++;
+					}
+					decimals_end = position;
+				}
+				if (digits == digits_end && decimals == decimals_end) {
+					return first;
+				}
+				while (decimals_end != decimals && decimals_end[-1] == '0') { // 1.500 == 1.5
+					decimals_end--;
+				}
+				if constexpr (std::is_integral<NUMBER>::value) {
+					// on wide_type, everything <= max * 10 + 9 fits
+					typedef typename wide_type<NUMBER>::type WIDE;
+					const WIDE max = static_cast<WIDE>(std::numeric_limits<NUMBER>::max());
+					// the magnitude of a negative number can be max + 1 ("-2147483648" for int)
+					const WIDE max_value = negative && std::is_signed<NUMBER>::value ? max + 1 : max;
+					WIDE value = 0;
+					WIDE power = 1;
+					for (char const* digit = digits; digit != digits_end; digit++) {
+						value = value * 10 + (*digit - '0');
+						if (value > max_value) {
+							return first;
+						}
+					}
+					for (char const* digit = decimals; digit != decimals_end; digit++) {
+						value = value * 10 + (*digit - '0');
+						power *= 10;
+						if (value > max_value || power > max) {
+							return first;
+						}
+					}
+					if (power != 1) {
+						const WIDE divisor = static_cast<WIDE>(binary_gcd(value, power));
+						value /= divisor;
+						power /= divisor;
+					}
+					numerator = static_cast<NUMBER>(negative ? -value : value);
+					denominator = static_cast<NUMBER>(power);
+				}
+				else if constexpr (std::is_constructible<NUMBER, std::string_view>::value) { // math::BigInt
+					std::string text(negative ? "-" : "");
+					text.append(digits, digits_end).append(decimals, decimals_end);
+					if (text.size() == (negative ? 1u : 0u)) {
+						text += '0';
+					}
+					numerator = NUMBER(std::string_view(text));
+					denominator = NUMBER(1);
+					for (char const* digit = decimals; digit != decimals_end; digit++) {
+						denominator = denominator * NUMBER(10);
+					}
+				}
+				else {
+					long double value = 0;
+					if (math::parse_number(first, position, value) != position) {
+						return first;
+					}
+					numerator = static_cast<NUMBER>(value);
+					denominator = NUMBER(1);
+				}
+				return position;
+			}
+		}
+	}
+
+	template<typename NUMBER>
+	constexpr char const* parse_frac(char const* first, char const* last, Frac<NUMBER>& frac) {
+		/*
+		reads "a", "a/b" or a decimal number ("1.25", "1.5/2") at first, returns the end of the fraction
+		(first if there isn't any or if it doesn't fit in NUMBER), no allocation for the built-in types
+		*/
+		NUMBER numerator = NUMBER(0);
+		NUMBER denominator = NUMBER(1);
+		char const* const position = detail::parse_decimal(first, last, numerator, denominator);
+		if (position == first) {
+			return first;
+		}
+		if (position == last || *position != '/') {
+			frac = Frac<NUMBER>(numerator, denominator);
+			return position;
+		}
+		NUMBER below_numerator = NUMBER(0);
+		NUMBER below_denominator = NUMBER(1);
+		char const* const end = detail::parse_decimal(position + 1, last, below_numerator, below_denominator);
+		if (end == position + 1) {
+			return first;
+		}
+		if (below_numerator == NUMBER(0)) {
+			error("math::parse_frac", "denominator cannot be 0 !");
+		}
+		if constexpr (std::is_integral<NUMBER>::value) {
+			// (a / b) / (c / d) = (a d) / (b c) on wide_type, reduced there only if it doesn't fit (Frac reduces it anyway)
+			typedef typename detail::wide_type<NUMBER>::type WIDE;
+			WIDE top = static_cast<WIDE>(numerator) * below_denominator;
+			WIDE bottom = static_cast<WIDE>(denominator) * below_numerator;
+			const WIDE lowest = static_cast<WIDE>(std::numeric_limits<NUMBER>::lowest());
+			const WIDE max = static_cast<WIDE>(std::numeric_limits<NUMBER>::max());
+			if (bottom < 0) { // the sign moves to top here : "-2147483648/-1" doesn't fit an int and Frac couldn't negate it
+				top = -top;
+				bottom = -bottom;
+			}
+			if (top < lowest || top > max || bottom > max) {
+				const WIDE divisor = static_cast<WIDE>(detail::binary_gcd(top, bottom));
+				top /= divisor;
+				bottom /= divisor;
+				if (top < lowest || top > max || bottom > max) {
+					return first;
+				}
+			}
+			frac = Frac<NUMBER>(static_cast<NUMBER>(top), static_cast<NUMBER>(bottom));
+		}
+		else {
+			frac = Frac<NUMBER>(numerator * below_denominator, denominator * below_numerator);
+		}
+		return end;
+	}
+
+	namespace detail {
+
+		template<typename NUMBER>
+		constexpr Frac<NUMBER> frac_literal(char const* expr, std::size_t length, char const* func_name) {
+			// evaluated at compile time for the integer types when the result is constexpr (an invalid expression doesn't compile then)
+			Frac<NUMBER> result;
+			if (math::parse_frac(expr, expr + length, result) != expr + length) {
+				error(func_name, "invalid frac expression : " + std::string(expr, length));
+			}
+			return result;
+		}
+
+		constexpr std::size_t literal_size(char const* expr) {
+			std::size_t size = 0u;
+			while (expr[size] != '\0') {
+				size++;
+			}
+			return size;
+		}
+
+		constexpr long long int ratio_gcd(long long int a, long long int b) {
+			return static_cast<long long int>(binary_gcd(a, b));
+		}
+	}
+
+	template<long long int NUMERATOR, long long int DENOMINATOR = 1>
+	struct Ratio {
+		/*
+		rational known at compile time, stored in the type like std::ratio => nothing to store or to compute at run time :
+			typedef math::Ratio<1, 1000> milli;
+			double meters = milli::scale(millimeters);
+			constexpr math::IFrac third = math::Ratio<2, 6>::frac<int>(); // 1/3
+		the values are reduced, the denominator is > 0, an overflow in ratio_multiply / ratio_add... doesn't compile
+		*/
+		static_assert(DENOMINATOR != 0, "math::Ratio : denominator cannot be 0");
+
+		static constexpr long long int numerator = (DENOMINATOR < 0 ? -NUMERATOR : NUMERATOR) / detail::ratio_gcd(NUMERATOR, DENOMINATOR);
+		static constexpr long long int denominator = (DENOMINATOR < 0 ? -DENOMINATOR : DENOMINATOR) / detail::ratio_gcd(NUMERATOR, DENOMINATOR);
+
+		typedef Ratio<numerator, denominator> type;
+
+		template<typename NUMBER>
+		static constexpr Frac<NUMBER> frac() {
+			return Frac<NUMBER>(static_cast<NUMBER>(numerator), static_cast<NUMBER>(denominator));
+		}
+
+		template<typename NUMBER>
+		static constexpr NUMBER scale(NUMBER value) {
+			/*
+			value * numerator / denominator
+			floating point : one multiplication by a constant
+			integers : on a wider integer then rounded toward 0, the division by a constant becomes a multiplication
+			*/
+			if constexpr (std::is_floating_point<NUMBER>::value) {
+				return value * (static_cast<NUMBER>(numerator) / static_cast<NUMBER>(denominator));
+			}
+			else if constexpr (std::is_integral<NUMBER>::value) {
+				if constexpr (denominator == 1) {
+					return static_cast<NUMBER>(value * numerator);
+				}
+				else {
+					// long long is enough for 32-bit values and factors, no 128-bit division then
+					constexpr bool small = sizeof(NUMBER) <= sizeof(int) && numerator <= std::numeric_limits<int>::max() && numerator >= std::numeric_limits<int>::min();
+					typedef typename std::conditional<small, long long int, typename detail::wide_type<long long int>::type>::type WIDE;
+					return static_cast<NUMBER>(static_cast<WIDE>(value) * numerator / denominator);
+				}
+			}
+			else {
+				return value * NUMBER(numerator) / NUMBER(denominator);
+			}
+		}
+
+		template<typename NUMBER>
+		static constexpr Frac<NUMBER> scale(Frac<NUMBER> const& value) {
+			return value * frac<NUMBER>();
+		}
+	};
+
+	// arithmetic on the types, common factors are removed before multiplying (like std::ratio)
+
+	template<typename A, typename B>
+	using ratio_multiply = typename Ratio<(A::numerator / detail::ratio_gcd(A::numerator, B::denominator)) * (B::numerator / detail::ratio_gcd(B::numerator, A::denominator)),
+		(A::denominator / detail::ratio_gcd(B::numerator, A::denominator)) * (B::denominator / detail::ratio_gcd(A::numerator, B::denominator))>::type;
+
+	template<typename A, typename B>
+	using ratio_divide = ratio_multiply<A, Ratio<B::denominator, B::numerator>>;
+
+	template<typename A, typename B>
+	using ratio_add = typename Ratio<A::numerator * (B::denominator / detail::ratio_gcd(A::denominator, B::denominator)) + B::numerator * (A::denominator / detail::ratio_gcd(A::denominator, B::denominator)),
+		A::denominator / detail::ratio_gcd(A::denominator, B::denominator) * B::denominator>::type;
+
+	template<typename A, typename B>
+	using ratio_subtract = ratio_add<A, Ratio<-B::numerator, B::denominator>>;
+}
+
+constexpr math::IFrac operator"" _ifrac(const char* expr, std::size_t length) {
+	// ex : Frac f = "3/2"_ifrac; <=> Frac f = Frac(3, 2), constexpr
+	return math::detail::frac_literal<int>(expr, length, "operator\"\" _ifrac");
+}
+
+inline math::FFrac operator"" _ffrac(const char* expr, std::size_t length) {
+	// ex : Frac f = "3/2"_ffrac; <=> Frac f = Frac(3, 2)
+	return math::detail::frac_literal<float>(expr, length, "operator\"\" _ffrac");
+}
+
+constexpr math::LIFrac operator"" _lifrac(const char* expr, std::size_t length) {
+	// ex : Frac f = "3/2"_lifrac; <=> Frac f = Frac(3, 2), constexpr
+	return math::detail::frac_literal<long long int>(expr, length, "operator\"\" _lifrac");
+}
+
+inline math::LFFrac operator"" _lffrac(const char* expr, std::size_t length) {
+	// ex : Frac f = "3/2"_lffrac; <=> Frac f = Frac(3, 2)
+	return math::detail::frac_literal<long double>(expr, length, "operator\"\" _lffrac");
+}
+
+constexpr math::IFrac operator"" _ifrac(const char* literal) {
+	// ex : 1.25_ifrac <=> Frac(5, 4), 3_ifrac <=> Frac(3), read from the digits => exact and constexpr
+	return math::detail::frac_literal<int>(literal, math::detail::literal_size(literal), "operator\"\" _ifrac");
+}
+
+constexpr math::FFrac operator"" _ffrac(long double result) {
+	return math::FFrac(static_cast<float>(result));
+}
+
+constexpr math::LIFrac operator"" _lifrac(const char* literal) {
+	// ex : 1.25_lifrac <=> Frac(5, 4), 3_lifrac <=> Frac(3), read from the digits => exact and constexpr
+	return math::detail::frac_literal<long long int>(literal, math::detail::literal_size(literal), "operator\"\" _lifrac");
+}
+
+constexpr math::LFFrac operator"" _lffrac(long double result) {
+	return math::LFFrac(result);
+}
+
+template<typename NUMBER>
+inline std::ostream& operator<<(std::ostream& stream, math::Frac<NUMBER> const& frac) {
+	if (frac.output_mode() == frac_mode::FRAC) {
+		stream << frac.numerator() << std::endl;
+		const std::size_t size = std::max(math::detail::frac_text(frac.numerator()).size(), math::detail::frac_text(frac.denominator()).size());
+		// fraction bar's length
+		for (std::size_t i = 0; i < size; i++) {
+			stream << '-';
+		}
+		return stream << std::endl << frac.denominator();
+	}
+	return stream << (frac.numerator() / frac.denominator());
+}
+
+template<typename NUMBER>
+inline std::istream& operator>>(std::istream& stream, math::Frac<NUMBER>& frac) {
+	// reads the next word of stream : "a", "a/b" or a decimal number ("1.25" => 5/4 for the integer types)
+	std::istream::sentry sentry(stream); // skips the spaces
+	if (!sentry) {
+		return stream;
+	}
+	char buffer[math::max_number_size];
+	std::size_t size = 0u;
+	std::streambuf* const input = stream.rdbuf();
+	for (int c = input->sgetc(); ; c = input->snextc()) {
+		if (c == std::char_traits<char>::eof()) {
+			stream.setstate(std::ios::eofbit);
+			break;
+		}
+		if (c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f') {
+			break;
+		}
+		if (size == math::max_number_size) {
+			error("operator>> math::Frac", "invalid frac expression : " + std::string(buffer, size) + "...");
+		}
+		buffer[size++] = static_cast<char>(c);
+	}
+	if (math::parse_frac(buffer, buffer + size, frac) != buffer + size) {
+		error("operator>> math::Frac", "invalid frac expression : " + std::string(buffer, size));
+	}
+	return stream;
+}
+
+namespace std {
+	template<typename NUMBER>
+	struct hash<math::Frac<NUMBER>> {
+		/*
+		hash of the canonical form => equal fractions have the same hash, even unreduced ones (ENABLE_LAZY_FRAC)
+		integer types : the reduced numerator and denominator (numerator() and denominator() are always reduced)
+		floating point types : the value numerator / denominator, only whole values are reduced by math::Frac
+		*/
+		std::size_t operator()(math::Frac<NUMBER> const& frac) const {
+			if constexpr (std::is_floating_point<NUMBER>::value) {
+				const NUMBER value = frac.numerator() / frac.denominator();
+				return std::hash<NUMBER>()(value == NUMBER(0) ? NUMBER(0) : value); // -0 == 0
+			}
+			else {
+				return math::detail::hash_combine(std::hash<NUMBER>()(frac.numerator()), std::hash<NUMBER>()(frac.denominator()));
+			}
+		}
+	};
+}
+
+#ifndef DISABLE_FRAC_TYPES
+// to be used in main
+
+constexpr frac_mode FRAC = frac_mode::FRAC;
+constexpr frac_mode NUMBER = frac_mode::NUMBER;
 #endif
\ No newline at end of file
@@ -0,0 +1,670 @@
+#pragma once
+
+#include "include.hpp"
+#include "frac.hpp"
+#include "batch.hpp"
+#include "mapped_file.hpp"
+#include <cstring>
+#include <string_view>
+
+/*
+math::FracArray<NUMBER> : a lot of fractions stored as two arrays (numerators, denominators) instead of a std::vector<math::Frac>
+=> no output mode per value (one for the whole array) and the operations go through the values by groups of detail::batch_lanes :
+	math::FracArray<int> a(values), b(others);
+	math::FracArray<int> c = a * b + a; // value by value
+	math::IFrac total = c.sum();
+for integer NUMBER, the cross products of a group are computed on the wide type of math::Frac (long long for int)
+and reduced together by detail::batch_gcd (with AVX2 or AVX-512), everything stays reduced (even with ENABLE_LAZY_FRAC)
+other NUMBER types (float, math::BigInt...) go through math::Frac value by value
+math::parse_frac_array / math::load_frac_array read a whole text (or file, memory mapped) of fractions, in parallel blocks
+sort() / unique() (and math::sort_fracs for a std::vector<math::Frac>) : radix sort on a double key, then the runs of close keys sorted with the exact comparison
+*/
+
+namespace math {
+
+	namespace detail {
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+		constexpr bool simd_gcd = true;
+#else
+		constexpr bool simd_gcd = false; // without 64-bit lanes in 256-bit vectors, batch_gcd is slower than one binary_gcd per value
+#endif
+
+		template<typename UNSIGNED>
+		void batch_gcd(UNSIGNED const (&a)[batch_lanes], UNSIGNED const (&b)[batch_lanes], UNSIGNED (&result)[batch_lanes]) {
+			/*
+			gcd of batch_lanes pairs at once, binary gcd where every lane does the same steps (no branch, one bit of v per step) :
+				v even : v = v / 2
+				v odd : u, v = min(u, v), |u - v| / 2
+			=> the loop on the lanes is vectorized, all the lanes stop when the biggest gcd is found, gcd(0, 0) = 0
+			*/
+			UNSIGNED u[batch_lanes];
+			UNSIGNED v[batch_lanes];
+			int shift[batch_lanes];
+			for (std::size_t lane = 0; lane < batch_lanes; lane++) {
+				const UNSIGNED both = a[lane] | b[lane];
+				shift[lane] = both == 0u ? 0 : trailing_zeros(both);
+				UNSIGNED x = a[lane] >> shift[lane];
+				UNSIGNED y = b[lane] >> shift[lane];
+				if ((x & 1u) == 0u) { // u must be odd (or 0 => gcd = v)
+					std::swap(x, y);
+				}
+				if (x == 0u) {
+					std::swap(x, y);
+				}
+				u[lane] = x;
+				v[lane] = y;
+			}
+			UNSIGNED left = 0u;
+			for (std::size_t lane = 0; lane < batch_lanes; lane++) {
+				left |= v[lane];
+			}
+			while (left != 0u) {
+				for (int step = 0; step < 8; step++) { // checking every lane at each step costs more than a few useless steps
+					for (std::size_t lane = 0; lane < batch_lanes; lane++) {
+						const UNSIGNED odd = UNSIGNED(0) - (v[lane] & 1u); // all bits set when v is odd
+						const UNSIGNED low = std::min(u[lane], v[lane]);
+						const UNSIGNED difference = std::max(u[lane], v[lane]) - low;
+						u[lane] = (low & odd) | (u[lane] & ~odd);
+						v[lane] = ((difference & odd) | (v[lane] & ~odd)) >> 1;
+					}
+				}
+				left = 0u;
+				for (std::size_t lane = 0; lane < batch_lanes; lane++) {
+					left |= v[lane];
+				}
+			}
+			for (std::size_t lane = 0; lane < batch_lanes; lane++) {
+				result[lane] = static_cast<UNSIGNED>(u[lane] << shift[lane]);
+			}
+		}
+
+		inline std::uint64_t order_key(double value) {
+			// unsigned integer with the same order as value : negative values reversed, positive ones after them
+			std::uint64_t bits = 0u;
+			std::memcpy(&bits, &value, sizeof(bits));
+			return (bits >> 63) != 0u ? ~bits : bits | (1ull << 63);
+		}
+
+		template<typename KEY>
+		std::vector<std::size_t> radix_order(std::size_t size, KEY const& key) {
+			/*
+			indices sorted by key(index) (64 bits), LSD radix sort : 4 passes of 16 bits,
+			a pass where every key has the same digit is skipped (the exponents of close values for example)
+			below 2^16 values the counts would cost more than the values => std::sort
+			*/
+			constexpr int digit = 16;
+			constexpr std::size_t digits = std::size_t(1) << digit;
+			struct Item {
+				std::uint64_t key;
+				std::size_t index;
+			};
+			std::vector<Item> items(size);
+			for (std::size_t index = 0; index < size; index++) {
+				items[index] = { key(index), index };
+			}
+			if (size < digits) {
+				std::sort(items.begin(), items.end(), [](Item const& a, Item const& b) {
+					return a.key < b.key;
+				});
+			}
+			else {
+				std::vector<Item> buffer(size);
+				std::vector<std::size_t> counts(digits);
+				for (int shift = 0; shift < 64; shift += digit) {
+					std::fill(counts.begin(), counts.end(), 0u);
+					for (Item const& item : items) {
+						counts[(item.key >> shift) & (digits - 1u)]++;
+					}
+					if (std::find(counts.begin(), counts.end(), size) != counts.end()) {
+						continue;
+					}
+					std::size_t offset = 0u;
+					for (std::size_t& count : counts) {
+						const std::size_t next = offset + count;
+						count = offset;
+						offset = next;
+					}
+					for (Item const& item : items) {
+						buffer[counts[(item.key >> shift) & (digits - 1u)]++] = item;
+					}
+					items.swap(buffer);
+				}
+			}
+			std::vector<std::size_t> order(size);
+			for (std::size_t index = 0; index < size; index++) {
+				order[index] = items[index].index;
+			}
+			return order;
+		}
+
+		constexpr std::uint64_t order_key_error = 32u; // the double quotient of 2 integers is off by < 4 roundings (< 8 ulps) => keys further apart are in order
+
+		template<typename NUMBER>
+		inline std::vector<std::size_t> frac_order(NUMBER const* numerators, NUMBER const* denominators, std::size_t size) {
+			// indices of the fractions numerators[i] / denominators[i] (denominators > 0) in increasing order, exact
+			typedef typename wide_type<NUMBER>::type WIDE;
+			auto less = [&](std::size_t a, std::size_t b) {
+				return static_cast<WIDE>(numerators[a]) * denominators[b] < static_cast<WIDE>(numerators[b]) * denominators[a];
+			};
+			if constexpr (std::is_integral<NUMBER>::value) {
+				/*
+				radix sort on the quotient as a double, only fractions with keys closer than order_key_error can be in the wrong order
+				=> every run of such keys (next to each other after the radix sort) is sorted again with the cross products
+				*/
+				std::vector<std::uint64_t> keys(size);
+				for (std::size_t index = 0; index < size; index++) {
+					keys[index] = order_key(static_cast<double>(numerators[index]) / static_cast<double>(denominators[index]));
+				}
+				std::vector<std::size_t> order = radix_order(size, [&](std::size_t index) {
+					return keys[index];
+				});
+				for (std::size_t first = 0; first < size;) {
+					std::size_t last = first + 1u;
+					while (last < size && keys[order[last]] - keys[order[last - 1u]] <= order_key_error) {
+						last++;
+					}
+					if (last - first > 1u) {
+						std::sort(order.begin() + static_cast<std::ptrdiff_t>(first), order.begin() + static_cast<std::ptrdiff_t>(last), less);
+					}
+					first = last;
+				}
+				return order;
+			}
+			else {
+				std::vector<std::size_t> order(size);
+				for (std::size_t index = 0; index < size; index++) {
+					order[index] = index;
+				}
+				std::sort(order.begin(), order.end(), less);
+				return order;
+			}
+		}
+	}
+
+	template<typename NUMBER, typename ALLOCATOR = std::allocator<NUMBER>>
+	class FracArray {
+		std::vector<NUMBER, ALLOCATOR> numerators_; // padded to a multiple of detail::batch_lanes with 0 / 1
+		std::vector<NUMBER, ALLOCATOR> denominators_; // always > 0
+		std::size_t size_ = 0u;
+		frac_mode output_ = frac_mode::FRAC;
+
+		typedef typename detail::wide_type<NUMBER>::type wide_type;
+
+		static constexpr bool batched = std::is_integral<NUMBER>::value;
+
+		static inline std::size_t padded(std::size_t size) {
+			return (size + detail::batch_lanes - 1u) / detail::batch_lanes * detail::batch_lanes;
+		}
+
+		static inline bool fits(wide_type value) {
+			return value >= static_cast<wide_type>(std::numeric_limits<NUMBER>::lowest()) && value <= static_cast<wide_type>(std::numeric_limits<NUMBER>::max());
+		}
+
+		void store(std::size_t first, std::size_t count, wide_type (&numerators)[detail::batch_lanes], wide_type (&denominators)[detail::batch_lanes], std::string const& func_name) {
+			// reduces a group of results (wide_type) and stores its first count values from first
+			typedef typename detail::unsigned_type<wide_type>::type UNSIGNED;
+			for (std::size_t lane = 0; lane < detail::batch_lanes; lane++) {
+				if (denominators[lane] == 0) {
+					if (lane < count) {
+						error(func_name, "denominator cannot be 0 !");
+					}
+					denominators[lane] = 1; // padding
+				}
+			}
+			for (std::size_t lane = 0; lane < detail::batch_lanes; lane++) {
+				const bool negative = denominators[lane] < 0;
+				numerators[lane] = negative ? -numerators[lane] : numerators[lane];
+				denominators[lane] = negative ? -denominators[lane] : denominators[lane];
+			}
+			UNSIGNED divisors[detail::batch_lanes];
+			if constexpr (detail::simd_gcd && sizeof(wide_type) <= sizeof(unsigned long long int)) {
+				UNSIGNED u[detail::batch_lanes];
+				UNSIGNED v[detail::batch_lanes];
+				for (std::size_t lane = 0; lane < detail::batch_lanes; lane++) {
+					u[lane] = detail::unsigned_abs(numerators[lane]);
+					v[lane] = static_cast<UNSIGNED>(denominators[lane]);
+				}
+				detail::batch_gcd(u, v, divisors);
+			}
+			else { // no SIMD lane that wide (128 bits) or no SIMD at all, one gcd at a time
+				for (std::size_t lane = 0; lane < detail::batch_lanes; lane++) {
+					divisors[lane] = detail::binary_gcd(numerators[lane], denominators[lane]);
+				}
+			}
+			for (std::size_t lane = 0; lane < count; lane++) {
+				const wide_type divisor = static_cast<wide_type>(divisors[lane]);
+				const wide_type numerator = divisor > 1 ? numerators[lane] / divisor : numerators[lane];
+				const wide_type denominator = divisor > 1 ? denominators[lane] / divisor : denominators[lane];
+#ifdef ENABLE_FRAC_OVERFLOW_CHECK
+				if (!fits(numerator) || !fits(denominator)) {
+					error(func_name, "overflow, the result doesn't fit in the integer type (math::Frac<math::BigInt> never overflows)");
+				}
+#endif
+				numerators_[first + lane] = static_cast<NUMBER>(numerator);
+				denominators_[first + lane] = static_cast<NUMBER>(denominator);
+			}
+		}
+
+		template<typename OPERATION>
+		FracArray combine(FracArray const& frac_array, OPERATION const& operation, std::string const& func_name) const {
+			// operation(numerator a, denominator a, numerator b, denominator b, numerator, denominator) for every value
+			if (frac_array.size_ != size_) {
+				error(func_name, "the arrays have different sizes : " + std::to_string(size_) + " and " + std::to_string(frac_array.size_));
+			}
+			FracArray result(size_, numerators_.get_allocator());
+			result.output_ = output_;
+			if constexpr (batched) {
+				detail::batch_for(size_, [&](std::size_t first) {
+					wide_type numerators[detail::batch_lanes];
+					wide_type denominators[detail::batch_lanes];
+					NUMBER const* a_numerators = numerators_.data() + first;
+					NUMBER const* a_denominators = denominators_.data() + first;
+					NUMBER const* b_numerators = frac_array.numerators_.data() + first;
+					NUMBER const* b_denominators = frac_array.denominators_.data() + first;
+					for (std::size_t lane = 0; lane < detail::batch_lanes; lane++) {
+						operation(static_cast<wide_type>(a_numerators[lane]), static_cast<wide_type>(a_denominators[lane]), static_cast<wide_type>(b_numerators[lane]), static_cast<wide_type>(b_denominators[lane]), numerators[lane], denominators[lane]);
+					}
+					result.store(first, std::min(detail::batch_lanes, size_ - first), numerators, denominators, func_name);
+				});
+			}
+			else {
+				detail::batch_for(size_, [&](std::size_t first) {
+					const std::size_t last = std::min(first + detail::batch_lanes, size_);
+					for (std::size_t index = first; index < last; index++) {
+						NUMBER numerator = NUMBER(0);
+						NUMBER denominator = NUMBER(1);
+						operation(numerators_[index], denominators_[index], frac_array.numerators_[index], frac_array.denominators_[index], numerator, denominator);
+						result.set(index, Frac<NUMBER>(numerator, denominator)); // reduced by Frac
+					}
+				});
+			}
+			return result;
+		}
+
+		char const* parse_raw(char const* first, char const* last) {
+			/*
+			reads "a" or "a/b" at first and adds it without reducing it (reduce_all() does it by groups later)
+			returns first if it isn't that simple (decimal numbers, values that don't fit...) => read by math::parse_frac
+			*/
+			NUMBER numerator = NUMBER(0);
+			NUMBER denominator = NUMBER(1);
+			char const* const position = detail::parse_decimal(first, last, numerator, denominator);
+			if (position == first || denominator != NUMBER(1)) {
+				return first;
+			}
+			NUMBER below = NUMBER(1);
+			char const* end = position;
+			if (position != last && *position == '/') {
+				end = detail::parse_decimal(position + 1, last, below, denominator);
+				if (end == position + 1 || denominator != NUMBER(1) || below == NUMBER(0)) {
+					return first;
+				}
+				if (below < NUMBER(0) && (numerator == std::numeric_limits<NUMBER>::lowest() || below == std::numeric_limits<NUMBER>::lowest())) {
+					return first; // the sign moves to the numerator : may not fit ("-2147483648/-1"), math::parse_frac checks it
+				}
+			}
+			if (size_ == numerators_.size()) {
+				numerators_.resize(size_ + detail::batch_lanes, NUMBER(0));
+				denominators_.resize(size_ + detail::batch_lanes, NUMBER(1));
+			}
+			numerators_[size_] = numerator;
+			denominators_[size_] = below; // can be < 0 until reduce_all()
+			size_++;
+			return end;
+		}
+
+		void reduce_all() {
+			for (std::size_t first = 0; first < size_; first += detail::batch_lanes) {
+				wide_type numerators[detail::batch_lanes];
+				wide_type denominators[detail::batch_lanes];
+				for (std::size_t lane = 0; lane < detail::batch_lanes; lane++) {
+					numerators[lane] = static_cast<wide_type>(numerators_[first + lane]);
+					denominators[lane] = static_cast<wide_type>(denominators_[first + lane]);
+				}
+				store(first, std::min(detail::batch_lanes, size_ - first), numerators, denominators, "math::parse_frac_array");
+			}
+		}
+
+		template<typename TERM>
+		Frac<NUMBER> accumulate(TERM const& term) const {
+			// sum of term(index), one partial sum per block of detail::batch_block values, added in order at the end
+			const std::size_t blocks = (size_ + detail::batch_block - 1u) / detail::batch_block;
+			std::vector<Frac<NUMBER>> sums(blocks, Frac<NUMBER>(NUMBER(0)));
+			math::parallel_for(blocks, [&](std::size_t block) {
+				Frac<NUMBER> sum(NUMBER(0));
+				const std::size_t last = std::min(size_, (block + 1u) * detail::batch_block);
+				for (std::size_t index = block * detail::batch_block; index < last; index++) {
+					sum = sum + term(index);
+				}
+				sums[block] = sum;
+			});
+			Frac<NUMBER> result(NUMBER(0));
+			for (Frac<NUMBER> const& sum : sums) {
+				result = result + sum;
+			}
+			result.output_mode(output_);
+			return result;
+		}
+
+	public:
+		typedef NUMBER number_type;
+		typedef ALLOCATOR allocator_type;
+
+		explicit FracArray(std::size_t size = 0u, ALLOCATOR const& allocator = ALLOCATOR()) : numerators_(padded(size), NUMBER(0), allocator), denominators_(padded(size), NUMBER(1), allocator), size_(size) {}
+
+		FracArray(std::size_t size, Frac<NUMBER> const& value, ALLOCATOR const& allocator = ALLOCATOR()) : FracArray(size, allocator) { // size copies of value
+			std::fill(numerators_.begin(), numerators_.begin() + size_, value.numerator());
+			std::fill(denominators_.begin(), denominators_.begin() + size_, value.denominator());
+		}
+
+		FracArray(std::vector<Frac<NUMBER>> const& values, ALLOCATOR const& allocator = ALLOCATOR()) : FracArray(values.size(), allocator) {
+			for (std::size_t index = 0; index < size_; index++) {
+				set(index, values[index]);
+			}
+		}
+
+		FracArray(std::vector<NUMBER> const& numerators, std::vector<NUMBER> const& denominators, ALLOCATOR const& allocator = ALLOCATOR()) : FracArray(numerators.size(), allocator) {
+			// reduced here, error if a denominator is 0
+			if (denominators.size() != numerators.size()) {
+				error("math::FracArray::FracArray", "numerators.size() (" + std::to_string(numerators.size()) + ") != denominators.size() (" + std::to_string(denominators.size()) + ")");
+			}
+			for (std::size_t index = 0; index < size_; index++) {
+				set(index, Frac<NUMBER>(numerators[index], denominators[index]));
+			}
+		}
+
+		inline std::size_t size() const {
+			return size_;
+		}
+
+		inline bool empty() const {
+			return size_ == 0u;
+		}
+
+		inline ALLOCATOR get_allocator() const {
+			return numerators_.get_allocator();
+		}
+
+		inline NUMBER const* numerators() const {
+			return numerators_.data();
+		}
+
+		inline NUMBER const* denominators() const {
+			return denominators_.data();
+		}
+
+		inline Frac<NUMBER> get(std::size_t index) const {
+			Frac<NUMBER> result(numerators_[index], denominators_[index]);
+			result.output_mode(output_);
+			return result;
+		}
+
+		inline void set(std::size_t index, Frac<NUMBER> const& value) {
+			numerators_[index] = value.numerator();
+			denominators_[index] = value.denominator();
+		}
+
+		void push_back(Frac<NUMBER> const& value) {
+			if (size_ == numerators_.size()) { // one more group of padding values
+				numerators_.resize(size_ + detail::batch_lanes, NUMBER(0));
+				denominators_.resize(size_ + detail::batch_lanes, NUMBER(1));
+			}
+			set(size_, value);
+			size_++;
+		}
+
+		void resize(std::size_t size) { // the new values are 0
+			numerators_.resize(padded(size), NUMBER(0));
+			denominators_.resize(padded(size), NUMBER(1));
+			for (std::size_t index = std::min(size_, size); index < numerators_.size(); index++) {
+				numerators_[index] = NUMBER(0);
+				denominators_[index] = NUMBER(1);
+			}
+			size_ = size;
+		}
+
+		std::vector<Frac<NUMBER>> to_vector() const {
+			std::vector<Frac<NUMBER>> result;
+			result.reserve(size_);
+			for (std::size_t index = 0; index < size_; index++) {
+				result.push_back(get(index));
+			}
+			return result;
+		}
+
+		static FracArray parse(std::string_view text, ALLOCATOR const& allocator = ALLOCATOR()) {
+			/*
+			fractions read by math::parse_frac ("a", "a/b", "1.25"), separated by spaces, new lines, ',' or ';'
+			'[' and ']' are ignored => reads the output of operator<< in FRAC mode
+			a big text is cut (between two fractions) in blocks of parse_block chars, parsed in parallel
+			*/
+			constexpr std::size_t parse_block = 1u << 20;
+			auto separator = [](char c) {
+				return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == ',' || c == ';' || c == '[' || c == ']';
+			};
+			std::vector<std::size_t> bounds(1u, 0u);
+			while (bounds.back() != text.size()) {
+				std::size_t bound = std::min(text.size(), bounds.back() + parse_block);
+				while (bound != text.size() && !separator(text[bound])) {
+					bound++;
+				}
+				bounds.push_back(bound);
+			}
+			std::vector<FracArray> parts(bounds.size() - 1u, FracArray(0u, allocator));
+			math::parallel_for(parts.size(), [&](std::size_t part) {
+				char const* position = text.data() + bounds[part];
+				char const* const last = text.data() + bounds[part + 1u];
+				Frac<NUMBER> value;
+				while (true) {
+					while (position != last && separator(*position)) {
+						position++;
+					}
+					if (position == last) {
+						break;
+					}
+					char const* next = position;
+					if constexpr (batched) {
+						next = parts[part].parse_raw(position, last);
+					}
+					if (next == position) {
+						next = math::parse_frac(position, last, value);
+						if (next != position) {
+							parts[part].push_back(value);
+						}
+					}
+					if (next == position || (next != last && !separator(*next))) {
+						error("math::parse_frac_array", "invalid fraction : " + std::string(position, std::find_if(position, last, separator)));
+					}
+					position = next;
+				}
+				if constexpr (batched) {
+					parts[part].reduce_all();
+				}
+			});
+			if (parts.size() == 1u) {
+				return std::move(parts[0]);
+			}
+			std::size_t size = 0u;
+			for (FracArray const& part : parts) {
+				size += part.size_;
+			}
+			FracArray result(size, allocator);
+			std::size_t offset = 0u;
+			for (FracArray const& part : parts) {
+				std::copy(part.numerators_.begin(), part.numerators_.begin() + part.size_, result.numerators_.begin() + offset);
+				std::copy(part.denominators_.begin(), part.denominators_.begin() + part.size_, result.denominators_.begin() + offset);
+				offset += part.size_;
+			}
+			return result;
+		}
+
+		void sort() {
+			// increasing order, exact (radix sort on numerator / denominator as a double, the close values sorted again with the cross products)
+			const std::vector<std::size_t> order = detail::frac_order(numerators_.data(), denominators_.data(), size_);
+			std::vector<NUMBER, ALLOCATOR> numerators(numerators_.size(), NUMBER(0), numerators_.get_allocator());
+			std::vector<NUMBER, ALLOCATOR> denominators(denominators_.size(), NUMBER(1), denominators_.get_allocator());
+			for (std::size_t index = 0; index < size_; index++) {
+				numerators[index] = numerators_[order[index]];
+				denominators[index] = denominators_[order[index]];
+			}
+			numerators_.swap(numerators);
+			denominators_.swap(denominators);
+		}
+
+		void unique() {
+			// removes the repeated values that follow each other (all of them after sort()), the values are reduced => equal means same numerator and denominator
+			std::size_t size = 0u;
+			for (std::size_t index = 0; index < size_; index++) {
+				if (size == 0u || numerators_[index] != numerators_[size - 1u] || denominators_[index] != denominators_[size - 1u]) {
+					numerators_[size] = numerators_[index];
+					denominators_[size] = denominators_[index];
+					size++;
+				}
+			}
+			resize(size);
+		}
+
+		inline frac_mode output_mode() const {
+			return output_;
+		}
+
+		inline void output_mode(frac_mode mode) {
+			output_ = mode;
+		}
+
+		FracArray operator+(FracArray const& frac_array) const {
+			return combine(frac_array, [](auto a, auto b, auto c, auto d, auto& numerator, auto& denominator) {
+				numerator = a * d + c * b;
+				denominator = b * d;
+			}, "math::FracArray::operator+");
+		}
+
+		FracArray operator-(FracArray const& frac_array) const {
+			return combine(frac_array, [](auto a, auto b, auto c, auto d, auto& numerator, auto& denominator) {
+				numerator = a * d - c * b;
+				denominator = b * d;
+			}, "math::FracArray::operator-");
+		}
+
+		FracArray operator*(FracArray const& frac_array) const {
+			return combine(frac_array, [](auto a, auto b, auto c, auto d, auto& numerator, auto& denominator) {
+				numerator = a * c;
+				denominator = b * d;
+			}, "math::FracArray::operator*");
+		}
+
+		FracArray operator/(FracArray const& frac_array) const {
+			return combine(frac_array, [](auto a, auto b, auto c, auto d, auto& numerator, auto& denominator) {
+				numerator = a * d;
+				denominator = b * c;
+			}, "math::FracArray::operator/");
+		}
+
+		inline FracArray operator+(Frac<NUMBER> const& value) const {
+			return *this + FracArray(size_, value, numerators_.get_allocator());
+		}
+
+		inline FracArray operator-(Frac<NUMBER> const& value) const {
+			return *this - FracArray(size_, value, numerators_.get_allocator());
+		}
+
+		inline FracArray operator*(Frac<NUMBER> const& value) const {
+			return *this * FracArray(size_, value, numerators_.get_allocator());
+		}
+
+		inline FracArray operator/(Frac<NUMBER> const& value) const {
+			return *this / FracArray(size_, value, numerators_.get_allocator());
+		}
+
+		std::vector<int> compare(FracArray const& frac_array) const {
+			// -1, 0 or 1 for each value : sign of a / b - c / d = sign of a * d - c * b (b, d > 0), no division
+			if (frac_array.size_ != size_) {
+				error("math::FracArray::compare", "the arrays have different sizes : " + std::to_string(size_) + " and " + std::to_string(frac_array.size_));
+			}
+			std::vector<int> result(padded(size_));
+			detail::batch_for(size_, [&](std::size_t first) {
+				for (std::size_t lane = 0; lane < detail::batch_lanes; lane++) {
+					const std::size_t index = first + lane;
+					const wide_type left = static_cast<wide_type>(numerators_[index]) * static_cast<wide_type>(frac_array.denominators_[index]);
+					const wide_type right = static_cast<wide_type>(frac_array.numerators_[index]) * static_cast<wide_type>(denominators_[index]);
+					result[index] = (left > right) - (left < right);
+				}
+			});
+			result.resize(size_);
+			return result;
+		}
+
+		Frac<NUMBER> sum() const {
+			return accumulate([&](std::size_t index) {
+				return Frac<NUMBER>(numerators_[index], denominators_[index]);
+			});
+		}
+
+		Frac<NUMBER> dot(FracArray const& frac_array) const {
+			// sum of the products value by value
+			if (frac_array.size_ != size_) {
+				error("math::FracArray::dot", "the arrays have different sizes : " + std::to_string(size_) + " and " + std::to_string(frac_array.size_));
+			}
+			return accumulate([&](std::size_t index) {
+				return Frac<NUMBER>(numerators_[index], denominators_[index]) * Frac<NUMBER>(frac_array.numerators_[index], frac_array.denominators_[index]);
+			});
+		}
+	};
+
+	template<typename NUMBER, typename ALLOCATOR = std::allocator<NUMBER>>
+	inline FracArray<NUMBER, ALLOCATOR> parse_frac_array(std::string_view text, ALLOCATOR const& allocator = ALLOCATOR()) {
+		return FracArray<NUMBER, ALLOCATOR>::parse(text, allocator);
+	}
+
+	template<typename NUMBER>
+	inline std::vector<Frac<NUMBER>> parse_fracs(std::string_view text) {
+		return FracArray<NUMBER>::parse(text).to_vector();
+	}
+
+	template<typename NUMBER, typename ALLOCATOR = std::allocator<NUMBER>>
+	FracArray<NUMBER, ALLOCATOR> load_frac_array(std::string const& path, ALLOCATOR const& allocator = ALLOCATOR()) {
+		// the file is memory mapped and parsed in place, never copied
+		const MappedFile file(path);
+		return FracArray<NUMBER, ALLOCATOR>::parse(std::string_view(file.data(), file.size()), allocator);
+	}
+
+	template<typename NUMBER>
+	void sort_fracs(std::vector<Frac<NUMBER>>& fracs) {
+		// same as std::sort(fracs.begin(), fracs.end()), O(n) for the integer types (see FracArray::sort)
+		std::vector<NUMBER> numerators(fracs.size());
+		std::vector<NUMBER> denominators(fracs.size());
+		for (std::size_t index = 0; index < fracs.size(); index++) {
+			numerators[index] = fracs[index].numerator();
+			denominators[index] = fracs[index].denominator();
+		}
+		const std::vector<std::size_t> order = detail::frac_order(numerators.data(), denominators.data(), fracs.size());
+		std::vector<Frac<NUMBER>> sorted;
+		sorted.reserve(fracs.size());
+		for (std::size_t index : order) {
+			sorted.push_back(std::move(fracs[index]));
+		}
+		fracs.swap(sorted);
+	}
+
+	typedef math::FracArray<int> IFracArray;
+	typedef math::FracArray<long long int> LIFracArray;
+}
+
+template<typename NUMBER, typename ALLOCATOR>
+std::ostream& operator<<(std::ostream& stream, math::FracArray<NUMBER, ALLOCATOR> const& frac_array) {
+	// [a/b, c/d] in FRAC mode, [a / b, c / d] computed in NUMBER mode
+	stream << '[';
+	for (std::size_t index = 0; index < frac_array.size(); index++) {
+		if (frac_array.output_mode() == frac_mode::FRAC) {
+			stream << frac_array.numerators()[index] << '/' << frac_array.denominators()[index];
+		}
+		else {
+			stream << frac_array.numerators()[index] / frac_array.denominators()[index];
+		}
+		if (index != frac_array.size() - 1u) {
+			stream << ", ";
+		}
+	}
+	return stream << ']';
+}
@@ -0,0 +1,339 @@
+#pragma once
+
+#include "include.hpp"
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+/*
+C = alpha * A * B + beta * C on raw row-major buffers, used by math::Matrix2D's products
+
+A is m x k (lines of lda values), B is k x n (lines of ldb values), C is m x n (lines of ldc values)
+the loops are tiled for the caches :
+- B is copied by blocks of KC x NC into slivers of NR columns (stays in L2/L3)
+- A is copied by blocks of MC x KC into slivers of MR lines (stays in L2)
+- a micro-kernel computes a MR x NR tile of C in registers, reading one sliver of each
+MR / NR and the kernels depend on NUMBER (see gemm_kernel), other types use the scalar kernel
+*/
+
+namespace math {
+
+	namespace detail {
+
+		template<typename NUMBER>
+		struct gemm_kernel { // scalar fallback, works with every NUMBER having + and *
+			static constexpr std::size_t MR = 4u;
+			static constexpr std::size_t NR = 4u;
+
+			static void run(std::size_t kc, NUMBER const* a, NUMBER const* b, NUMBER* c, std::size_t ldc, NUMBER alpha) {
+				NUMBER ab[MR * NR];
+				std::fill(ab, ab + MR * NR, NUMBER());
+				for (std::size_t p = 0; p < kc; p++) {
+					for (std::size_t i = 0; i < MR; i++) {
+						for (std::size_t j = 0; j < NR; j++) {
+							ab[i * NR + j] += a[i] * b[j];
+						}
+					}
+					a += MR;
+					b += NR;
+				}
+				for (std::size_t i = 0; i < MR; i++) {
+					for (std::size_t j = 0; j < NR; j++) {
+						c[i * ldc + j] += alpha * ab[i * NR + j];
+					}
+				}
+			}
+		};
+
+#if defined(__AVX512F__)
+		template<>
+		struct gemm_kernel<float> { // 6 x 32 tile = 12 zmm accumulators
+			static constexpr std::size_t MR = 6u;
+			static constexpr std::size_t NR = 32u;
+
+			static void run(std::size_t kc, float const* a, float const* b, float* c, std::size_t ldc, float alpha) {
+				__m512 ab[MR][2];
+				for (std::size_t i = 0; i < MR; i++) {
+					ab[i][0] = _mm512_setzero_ps();
+					ab[i][1] = _mm512_setzero_ps();
+				}
+				for (std::size_t p = 0; p < kc; p++) {
+					const __m512 b0 = _mm512_loadu_ps(b);
+					const __m512 b1 = _mm512_loadu_ps(b + 16);
+					for (std::size_t i = 0; i < MR; i++) {
+						const __m512 ai = _mm512_set1_ps(a[i]);
+						ab[i][0] = _mm512_fmadd_ps(ai, b0, ab[i][0]);
+						ab[i][1] = _mm512_fmadd_ps(ai, b1, ab[i][1]);
+					}
+					a += MR;
+					b += NR;
+				}
+				const __m512 factor = _mm512_set1_ps(alpha);
+				for (std::size_t i = 0; i < MR; i++) {
+					_mm512_storeu_ps(c + i * ldc, _mm512_fmadd_ps(factor, ab[i][0], _mm512_loadu_ps(c + i * ldc)));
+					_mm512_storeu_ps(c + i * ldc + 16, _mm512_fmadd_ps(factor, ab[i][1], _mm512_loadu_ps(c + i * ldc + 16)));
+				}
+			}
+		};
+
+		template<>
+		struct gemm_kernel<double> { // 6 x 16 tile
+			static constexpr std::size_t MR = 6u;
+			static constexpr std::size_t NR = 16u;
+
+			static void run(std::size_t kc, double const* a, double const* b, double* c, std::size_t ldc, double alpha) {
+				__m512d ab[MR][2];
+				for (std::size_t i = 0; i < MR; i++) {
+					ab[i][0] = _mm512_setzero_pd();
+					ab[i][1] = _mm512_setzero_pd();
+				}
+				for (std::size_t p = 0; p < kc; p++) {
+					const __m512d b0 = _mm512_loadu_pd(b);
+					const __m512d b1 = _mm512_loadu_pd(b + 8);
+					for (std::size_t i = 0; i < MR; i++) {
+						const __m512d ai = _mm512_set1_pd(a[i]);
+						ab[i][0] = _mm512_fmadd_pd(ai, b0, ab[i][0]);
+						ab[i][1] = _mm512_fmadd_pd(ai, b1, ab[i][1]);
+					}
+					a += MR;
+					b += NR;
+				}
+				const __m512d factor = _mm512_set1_pd(alpha);
+				for (std::size_t i = 0; i < MR; i++) {
+					_mm512_storeu_pd(c + i * ldc, _mm512_fmadd_pd(factor, ab[i][0], _mm512_loadu_pd(c + i * ldc)));
+					_mm512_storeu_pd(c + i * ldc + 8, _mm512_fmadd_pd(factor, ab[i][1], _mm512_loadu_pd(c + i * ldc + 8)));
+				}
+			}
+		};
+
+		template<>
+		struct gemm_kernel<int> { // 6 x 32 tile, no fma for integers => mullo + add
+			static constexpr std::size_t MR = 6u;
+			static constexpr std::size_t NR = 32u;
+
+			static void run(std::size_t kc, int const* a, int const* b, int* c, std::size_t ldc, int alpha) {
+				__m512i ab[MR][2];
+				for (std::size_t i = 0; i < MR; i++) {
+					ab[i][0] = _mm512_setzero_si512();
+					ab[i][1] = _mm512_setzero_si512();
+				}
+				for (std::size_t p = 0; p < kc; p++) {
+					const __m512i b0 = _mm512_loadu_si512(b);
+					const __m512i b1 = _mm512_loadu_si512(b + 16);
+					for (std::size_t i = 0; i < MR; i++) {
+						const __m512i ai = _mm512_set1_epi32(a[i]);
+						ab[i][0] = _mm512_add_epi32(ab[i][0], _mm512_mullo_epi32(ai, b0));
+						ab[i][1] = _mm512_add_epi32(ab[i][1], _mm512_mullo_epi32(ai, b1));
+					}
+					a += MR;
+					b += NR;
+				}
+				const __m512i factor = _mm512_set1_epi32(alpha);
+				for (std::size_t i = 0; i < MR; i++) {
+					_mm512_storeu_si512(c + i * ldc, _mm512_add_epi32(_mm512_loadu_si512(c + i * ldc), _mm512_mullo_epi32(factor, ab[i][0])));
+					_mm512_storeu_si512(c + i * ldc + 16, _mm512_add_epi32(_mm512_loadu_si512(c + i * ldc + 16), _mm512_mullo_epi32(factor, ab[i][1])));
+				}
+			}
+		};
+#elif defined(__AVX2__) && defined(__FMA__)
+		template<>
+		struct gemm_kernel<float> { // 6 x 16 tile = 12 ymm accumulators
+			static constexpr std::size_t MR = 6u;
+			static constexpr std::size_t NR = 16u;
+
+			static void run(std::size_t kc, float const* a, float const* b, float* c, std::size_t ldc, float alpha) {
+				__m256 ab[MR][2];
+				for (std::size_t i = 0; i < MR; i++) {
+					ab[i][0] = _mm256_setzero_ps();
+					ab[i][1] = _mm256_setzero_ps();
+				}
+				for (std::size_t p = 0; p < kc; p++) {
+					const __m256 b0 = _mm256_loadu_ps(b);
+					const __m256 b1 = _mm256_loadu_ps(b + 8);
+					for (std::size_t i = 0; i < MR; i++) {
+						const __m256 ai = _mm256_broadcast_ss(a + i);
+						ab[i][0] = _mm256_fmadd_ps(ai, b0, ab[i][0]);
+						ab[i][1] = _mm256_fmadd_ps(ai, b1, ab[i][1]);
+					}
+					a += MR;
+					b += NR;
+				}
+				const __m256 factor = _mm256_set1_ps(alpha);
+				for (std::size_t i = 0; i < MR; i++) {
+					_mm256_storeu_ps(c + i * ldc, _mm256_fmadd_ps(factor, ab[i][0], _mm256_loadu_ps(c + i * ldc)));
+					_mm256_storeu_ps(c + i * ldc + 8, _mm256_fmadd_ps(factor, ab[i][1], _mm256_loadu_ps(c + i * ldc + 8)));
+				}
+			}
+		};
+
+		template<>
+		struct gemm_kernel<double> { // 6 x 8 tile
+			static constexpr std::size_t MR = 6u;
+			static constexpr std::size_t NR = 8u;
+
+			static void run(std::size_t kc, double const* a, double const* b, double* c, std::size_t ldc, double alpha) {
+				__m256d ab[MR][2];
+				for (std::size_t i = 0; i < MR; i++) {
+					ab[i][0] = _mm256_setzero_pd();
+					ab[i][1] = _mm256_setzero_pd();
+				}
+				for (std::size_t p = 0; p < kc; p++) {
+					const __m256d b0 = _mm256_loadu_pd(b);
+					const __m256d b1 = _mm256_loadu_pd(b + 4);
+					for (std::size_t i = 0; i < MR; i++) {
+						const __m256d ai = _mm256_broadcast_sd(a + i);
+						ab[i][0] = _mm256_fmadd_pd(ai, b0, ab[i][0]);
+						ab[i][1] = _mm256_fmadd_pd(ai, b1, ab[i][1]);
+					}
+					a += MR;
+					b += NR;
+				}
+				const __m256d factor = _mm256_set1_pd(alpha);
+				for (std::size_t i = 0; i < MR; i++) {
+					_mm256_storeu_pd(c + i * ldc, _mm256_fmadd_pd(factor, ab[i][0], _mm256_loadu_pd(c + i * ldc)));
+					_mm256_storeu_pd(c + i * ldc + 4, _mm256_fmadd_pd(factor, ab[i][1], _mm256_loadu_pd(c + i * ldc + 4)));
+				}
+			}
+		};
+#endif
+
+#if defined(__AVX2__) && !defined(__AVX512F__)
+		template<>
+		struct gemm_kernel<int> { // 6 x 16 tile
+			static constexpr std::size_t MR = 6u;
+			static constexpr std::size_t NR = 16u;
+
+			static void run(std::size_t kc, int const* a, int const* b, int* c, std::size_t ldc, int alpha) {
+				__m256i ab[MR][2];
+				for (std::size_t i = 0; i < MR; i++) {
+					ab[i][0] = _mm256_setzero_si256();
+					ab[i][1] = _mm256_setzero_si256();
+				}
+				for (std::size_t p = 0; p < kc; p++) {
+					const __m256i b0 = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(b));
+					const __m256i b1 = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(b + 8));
+					for (std::size_t i = 0; i < MR; i++) {
+						const __m256i ai = _mm256_set1_epi32(a[i]);
+						ab[i][0] = _mm256_add_epi32(ab[i][0], _mm256_mullo_epi32(ai, b0));
+						ab[i][1] = _mm256_add_epi32(ab[i][1], _mm256_mullo_epi32(ai, b1));
+					}
+					a += MR;
+					b += NR;
+				}
+				const __m256i factor = _mm256_set1_epi32(alpha);
+				for (std::size_t i = 0; i < MR; i++) {
+					for (std::size_t half = 0; half < 2u; half++) {
+						__m256i* target = reinterpret_cast<__m256i*>(c + i * ldc + half * 8u);
+						_mm256_storeu_si256(target, _mm256_add_epi32(_mm256_loadu_si256(target), _mm256_mullo_epi32(factor, ab[i][half])));
+					}
+				}
+			}
+		};
+#endif
+
+		template<typename NUMBER>
+		struct gemm_blocking {
+			// KC * NR values of B and KC * MR values of A stay in L1, MC * KC values of A in L2
+			static constexpr std::size_t KC = sizeof(NUMBER) <= 4u ? 384u : (sizeof(NUMBER) <= 8u ? 256u : 128u);
+			static constexpr std::size_t MC = 16u * gemm_kernel<NUMBER>::MR;
+			static constexpr std::size_t NC = 4096u;
+		};
+
+		template<typename NUMBER>
+		inline void gemm_pack_a(std::size_t mc, std::size_t kc, NUMBER const* a, std::size_t lda, NUMBER* packed) {
+			// slivers of MR lines, stored column after column, the last sliver is filled by NUMBER()
+			constexpr std::size_t MR = gemm_kernel<NUMBER>::MR;
+			for (std::size_t i = 0; i < mc; i += MR) {
+				const std::size_t rows = std::min(MR, mc - i);
+				for (std::size_t p = 0; p < kc; p++) {
+					for (std::size_t r = 0; r < rows; r++) {
+						packed[r] = a[(i + r) * lda + p];
+					}
+					for (std::size_t r = rows; r < MR; r++) {
+						packed[r] = NUMBER();
+					}
+					packed += MR;
+				}
+			}
+		}
+
+		template<typename NUMBER>
+		inline void gemm_pack_b(std::size_t kc, std::size_t nc, NUMBER const* b, std::size_t ldb, NUMBER* packed) {
+			// slivers of NR columns, stored line after line, the last sliver is filled by NUMBER()
+			constexpr std::size_t NR = gemm_kernel<NUMBER>::NR;
+			for (std::size_t j = 0; j < nc; j += NR) {
+				const std::size_t cols = std::min(NR, nc - j);
+				for (std::size_t p = 0; p < kc; p++) {
+					NUMBER const* line = b + p * ldb + j;
+					std::copy(line, line + cols, packed);
+					std::fill(packed + cols, packed + NR, NUMBER());
+					packed += NR;
+				}
+			}
+		}
+	}
+
+	template<typename NUMBER>
+	void gemm(std::size_t m, std::size_t n, std::size_t k, NUMBER alpha, NUMBER const* a, std::size_t lda, NUMBER const* b, std::size_t ldb, NUMBER beta, NUMBER* c, std::size_t ldc) {
+		typedef detail::gemm_kernel<NUMBER> kernel;
+		typedef detail::gemm_blocking<NUMBER> blocking;
+		constexpr std::size_t MR = kernel::MR;
+		constexpr std::size_t NR = kernel::NR;
+
+		// C = beta * C first, the kernels only accumulate
+		if (beta != static_cast<NUMBER>(1)) {
+			for (std::size_t i = 0; i < m; i++) {
+				NUMBER* line = c + i * ldc;
+				if (beta == NUMBER()) {
+					std::fill(line, line + n, NUMBER()); // doesn't keep NaNs from C
+				}
+				else {
+					for (std::size_t j = 0; j < n; j++) {
+						line[j] *= beta;
+					}
+				}
+			}
+		}
+		if (m == 0u || n == 0u || k == 0u || alpha == NUMBER()) {
+			return;
+		}
+
+		std::vector<NUMBER> packed_a(blocking::MC * blocking::KC);
+		std::vector<NUMBER> packed_b(((std::min(blocking::NC, n) + NR - 1u) / NR) * NR * blocking::KC);
+		NUMBER edge[MR * NR]; // partial tiles are computed here then added to C
+
+		for (std::size_t jc = 0; jc < n; jc += blocking::NC) {
+			const std::size_t nc = std::min(blocking::NC, n - jc);
+			for (std::size_t pc = 0; pc < k; pc += blocking::KC) {
+				const std::size_t kc = std::min(blocking::KC, k - pc);
+				detail::gemm_pack_b(kc, nc, b + pc * ldb + jc, ldb, packed_b.data());
+				for (std::size_t ic = 0; ic < m; ic += blocking::MC) {
+					const std::size_t mc = std::min(blocking::MC, m - ic);
+					detail::gemm_pack_a(mc, kc, a + ic * lda + pc, lda, packed_a.data());
+					for (std::size_t jr = 0; jr < nc; jr += NR) {
+						const std::size_t cols = std::min(NR, nc - jr);
+						NUMBER const* sliver_b = packed_b.data() + (jr / NR) * NR * kc;
+						for (std::size_t ir = 0; ir < mc; ir += MR) {
+							const std::size_t rows = std::min(MR, mc - ir);
+							NUMBER const* sliver_a = packed_a.data() + (ir / MR) * MR * kc;
+							NUMBER* tile = c + (ic + ir) * ldc + jc + jr;
+							if (rows == MR && cols == NR) {
+								kernel::run(kc, sliver_a, sliver_b, tile, ldc, alpha);
+							}
+							else {
+								std::fill(edge, edge + MR * NR, NUMBER());
+								kernel::run(kc, sliver_a, sliver_b, edge, NR, alpha);
+								for (std::size_t i = 0; i < rows; i++) {
+									for (std::size_t j = 0; j < cols; j++) {
+										tile[i * ldc + j] += edge[i * NR + j];
+									}
+								}
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+}
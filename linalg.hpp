@@ -0,0 +1,528 @@
+#pragma once
+
+#include "include.hpp"
+#include "matrix.hpp"
+#include "gemm.hpp"
+#include "fixed_matrix.hpp"
+
+/*
+decompositions of math::Matrix2D and the solvers built on them, NUMBER must be a floating point type
+the factorizations are blocked : a panel of block_size columns is factorized value by value,
+then the rest of the matrix is updated by a matrix product (math::gemm) => most of the work runs in the gemm kernels
+a decomposition can be kept and reused for as many right hand sides as needed :
+	math::LU<double> lu(a);
+	x = lu.solve(b1); y = lu.solve(b2);
+*/
+
+namespace math {
+
+	namespace detail {
+		constexpr std::size_t block_size = 64u; // columns per panel
+	}
+
+	template<typename NUMBER>
+	class LU {
+		// P * A = L * U with partial pivoting, L (unit diagonal) and U are stored in the same matrix
+		Matrix2D<NUMBER> lu_;
+		std::vector<std::size_t> permutation_; // line i of P * A is line permutation_[i] of A
+		bool odd_ = false; // odd number of swaps => determinant's sign changes
+		bool singular_ = false;
+
+		inline NUMBER& at(std::size_t line, std::size_t column) {
+			return lu_.data()[line * lu_.stride() + column];
+		}
+
+		void factorize() {
+			const std::size_t n = lu_.lines();
+			const std::size_t ld = lu_.stride();
+			NUMBER* a = lu_.data();
+			for (std::size_t k0 = 0; k0 < n; k0 += detail::block_size) {
+				const std::size_t kb = std::min(detail::block_size, n - k0);
+				// panel : columns k0 .. k0 + kb
+				for (std::size_t k = k0; k < k0 + kb; k++) {
+					std::size_t pivot = k;
+					for (std::size_t i = k + 1u; i < n; i++) {
+						if (detail::constexpr_abs(at(pivot, k)) < detail::constexpr_abs(at(i, k))) {
+							pivot = i;
+						}
+					}
+					if (pivot != k) {
+						std::swap_ranges(a + k * ld, a + k * ld + n, a + pivot * ld);
+						std::swap(permutation_[k], permutation_[pivot]);
+						odd_ = !odd_;
+					}
+					if (at(k, k) == NUMBER()) {
+						singular_ = true;
+						continue;
+					}
+					for (std::size_t i = k + 1u; i < n; i++) {
+						const NUMBER factor = at(i, k) /= at(k, k);
+						for (std::size_t j = k + 1u; j < k0 + kb; j++) {
+							at(i, j) -= factor * at(k, j);
+						}
+					}
+				}
+				if (k0 + kb == n) {
+					break;
+				}
+				// U12 = L11^-1 * A12
+				for (std::size_t i = k0 + 1u; i < k0 + kb; i++) {
+					for (std::size_t p = k0; p < i; p++) {
+						const NUMBER factor = at(i, p);
+						NUMBER const* source = a + p * ld;
+						NUMBER* target = a + i * ld;
+						for (std::size_t j = k0 + kb; j < n; j++) {
+							target[j] -= factor * source[j];
+						}
+					}
+				}
+				// A22 -= L21 * U12
+				const std::size_t rest = n - k0 - kb;
+				math::gemm(rest, rest, kb, static_cast<NUMBER>(-1), a + (k0 + kb) * ld + k0, ld, a + k0 * ld + k0 + kb, ld, static_cast<NUMBER>(1), a + (k0 + kb) * ld + k0 + kb, ld);
+			}
+		}
+
+	public:
+		LU(Matrix2D<NUMBER> const& matrix) : lu_(matrix), permutation_(matrix.lines()) {
+			if (matrix.lines() != matrix.columns()) {
+				error("math::LU::LU", "the matrix must be square (" + std::to_string(matrix.lines()) + "x" + std::to_string(matrix.columns()) + ")");
+			}
+			std::iota(permutation_.begin(), permutation_.end(), 0u);
+			factorize();
+		}
+
+		inline bool singular() const {
+			return singular_;
+		}
+
+		inline Matrix2D<NUMBER> const& factors() const {
+			return lu_;
+		}
+
+		inline std::vector<std::size_t> const& permutation() const {
+			return permutation_;
+		}
+
+		NUMBER determinant() const {
+			NUMBER result = static_cast<NUMBER>(odd_ ? -1 : 1);
+			for (std::size_t i = 0; i < lu_.lines(); i++) {
+				result *= lu_.value(i, i);
+			}
+			return result;
+		}
+
+		Matrix2D<NUMBER> solve(Matrix2D<NUMBER> const& b) const {
+			// A * X = B, line by line : each step updates a whole line of X => every right hand side at once
+			const std::size_t n = lu_.lines();
+			if (b.lines() != n) {
+				error("math::LU::solve", "b.lines() (" + std::to_string(b.lines()) + ") != " + std::to_string(n));
+			}
+			if (singular_) {
+				error("math::LU::solve", "the matrix is singular");
+			}
+			const std::size_t m = b.columns();
+			Matrix2D<NUMBER> x(n, m);
+			NUMBER* result = x.data();
+			const std::size_t ld = x.stride();
+			for (std::size_t i = 0; i < n; i++) {
+				NUMBER* target = result + i * ld;
+				std::copy(b.data() + permutation_[i] * b.stride(), b.data() + permutation_[i] * b.stride() + m, target);
+				for (std::size_t p = 0; p < i; p++) {
+					const NUMBER factor = lu_.value(i, p);
+					NUMBER const* source = result + p * ld;
+					for (std::size_t j = 0; j < m; j++) {
+						target[j] -= factor * source[j];
+					}
+				}
+			}
+			for (std::size_t i = n; i-- > 0;) {
+				NUMBER* target = result + i * ld;
+				for (std::size_t p = i + 1u; p < n; p++) {
+					const NUMBER factor = lu_.value(i, p);
+					NUMBER const* source = result + p * ld;
+					for (std::size_t j = 0; j < m; j++) {
+						target[j] -= factor * source[j];
+					}
+				}
+				const NUMBER diagonal = lu_.value(i, i);
+				for (std::size_t j = 0; j < m; j++) {
+					target[j] /= diagonal;
+				}
+			}
+			return x;
+		}
+
+		std::vector<NUMBER> solve(std::vector<NUMBER> const& b) const {
+			Matrix2D<NUMBER> column(b.size(), 1u);
+			for (std::size_t i = 0; i < b.size(); i++) {
+				column.data()[i * column.stride()] = b[i];
+			}
+			const Matrix2D<NUMBER> x = solve(column);
+			std::vector<NUMBER> result(b.size());
+			for (std::size_t i = 0; i < result.size(); i++) {
+				result[i] = x.value(i, 0);
+			}
+			return result;
+		}
+
+		Matrix2D<NUMBER> inverse() const {
+			Matrix2D<NUMBER> identity(lu_.lines(), lu_.lines());
+			for (std::size_t i = 0; i < lu_.lines(); i++) {
+				identity[i][i] = static_cast<NUMBER>(1);
+			}
+			return solve(identity);
+		}
+	};
+
+	template<typename NUMBER>
+	class Cholesky {
+		// A = L * L^T for a symmetric positive definite A, L is lower triangular
+		Matrix2D<NUMBER> l_;
+
+		void factorize() {
+			const std::size_t n = l_.lines();
+			const std::size_t ld = l_.stride();
+			NUMBER* a = l_.data();
+			std::vector<NUMBER> transposed;
+			for (std::size_t k0 = 0; k0 < n; k0 += detail::block_size) {
+				const std::size_t kb = std::min(detail::block_size, n - k0);
+				// L11 and L21 : the previous panels have already been subtracted
+				for (std::size_t j = k0; j < k0 + kb; j++) {
+					NUMBER const* line_j = a + j * ld;
+					NUMBER diagonal = line_j[j];
+					for (std::size_t p = k0; p < j; p++) {
+						diagonal -= line_j[p] * line_j[p];
+					}
+					if (!(NUMBER() < diagonal)) {
+						error("math::Cholesky::Cholesky", "the matrix is not positive definite");
+					}
+					diagonal = std::sqrt(diagonal);
+					a[j * ld + j] = diagonal;
+					for (std::size_t i = j + 1u; i < n; i++) {
+						NUMBER* line_i = a + i * ld;
+						NUMBER value = line_i[j];
+						for (std::size_t p = k0; p < j; p++) {
+							value -= line_i[p] * line_j[p];
+						}
+						line_i[j] = value / diagonal;
+					}
+				}
+				if (k0 + kb == n) {
+					break;
+				}
+				// A22 -= L21 * L21^T
+				const std::size_t rest = n - k0 - kb;
+				transposed.resize(kb * rest);
+				for (std::size_t i = 0; i < rest; i++) {
+					for (std::size_t p = 0; p < kb; p++) {
+						transposed[p * rest + i] = a[(k0 + kb + i) * ld + k0 + p];
+					}
+				}
+				math::gemm(rest, rest, kb, static_cast<NUMBER>(-1), a + (k0 + kb) * ld + k0, ld, transposed.data(), rest, static_cast<NUMBER>(1), a + (k0 + kb) * ld + k0 + kb, ld);
+			}
+			for (std::size_t i = 0; i < n; i++) { // upper part isn't L
+				std::fill(a + i * ld + i + 1u, a + i * ld + n, NUMBER());
+			}
+		}
+
+	public:
+		Cholesky(Matrix2D<NUMBER> const& matrix) : l_(matrix) {
+			if (matrix.lines() != matrix.columns()) {
+				error("math::Cholesky::Cholesky", "the matrix must be square (" + std::to_string(matrix.lines()) + "x" + std::to_string(matrix.columns()) + ")");
+			}
+			factorize();
+		}
+
+		inline Matrix2D<NUMBER> const& L() const {
+			return l_;
+		}
+
+		NUMBER determinant() const {
+			NUMBER result = static_cast<NUMBER>(1);
+			for (std::size_t i = 0; i < l_.lines(); i++) {
+				result *= l_.value(i, i) * l_.value(i, i);
+			}
+			return result;
+		}
+
+		Matrix2D<NUMBER> solve(Matrix2D<NUMBER> const& b) const {
+			// L * Y = B then L^T * X = Y
+			const std::size_t n = l_.lines();
+			if (b.lines() != n) {
+				error("math::Cholesky::solve", "b.lines() (" + std::to_string(b.lines()) + ") != " + std::to_string(n));
+			}
+			const std::size_t m = b.columns();
+			Matrix2D<NUMBER> x(n, m);
+			NUMBER* result = x.data();
+			const std::size_t ld = x.stride();
+			for (std::size_t i = 0; i < n; i++) {
+				NUMBER* target = result + i * ld;
+				std::copy(b.data() + i * b.stride(), b.data() + i * b.stride() + m, target);
+				for (std::size_t p = 0; p < i; p++) {
+					const NUMBER factor = l_.value(i, p);
+					NUMBER const* source = result + p * ld;
+					for (std::size_t j = 0; j < m; j++) {
+						target[j] -= factor * source[j];
+					}
+				}
+				const NUMBER diagonal = l_.value(i, i);
+				for (std::size_t j = 0; j < m; j++) {
+					target[j] /= diagonal;
+				}
+			}
+			for (std::size_t i = n; i-- > 0;) {
+				NUMBER* target = result + i * ld;
+				for (std::size_t p = i + 1u; p < n; p++) {
+					const NUMBER factor = l_.value(p, i);
+					NUMBER const* source = result + p * ld;
+					for (std::size_t j = 0; j < m; j++) {
+						target[j] -= factor * source[j];
+					}
+				}
+				const NUMBER diagonal = l_.value(i, i);
+				for (std::size_t j = 0; j < m; j++) {
+					target[j] /= diagonal;
+				}
+			}
+			return x;
+		}
+
+		std::vector<NUMBER> solve(std::vector<NUMBER> const& b) const {
+			Matrix2D<NUMBER> column(b.size(), 1u);
+			for (std::size_t i = 0; i < b.size(); i++) {
+				column.data()[i * column.stride()] = b[i];
+			}
+			const Matrix2D<NUMBER> x = solve(column);
+			std::vector<NUMBER> result(b.size());
+			for (std::size_t i = 0; i < result.size(); i++) {
+				result[i] = x.value(i, 0);
+			}
+			return result;
+		}
+
+		Matrix2D<NUMBER> inverse() const {
+			Matrix2D<NUMBER> identity(l_.lines(), l_.lines());
+			for (std::size_t i = 0; i < l_.lines(); i++) {
+				identity[i][i] = static_cast<NUMBER>(1);
+			}
+			return solve(identity);
+		}
+	};
+
+	template<typename NUMBER>
+	class QR {
+		/*
+		A = Q * R with householder reflections, A is m x n with m >= n
+		R is stored in the upper part, the reflectors v (v[0] = 1, not stored) under the diagonal
+		Q = H(0) * H(1) * ... * H(n - 1) with H(k) = I - tau[k] * v(k) * v(k)^T
+		a panel of reflectors is applied at once to the rest of the matrix : I - V * T * V^T
+		*/
+		Matrix2D<NUMBER> qr_;
+		std::vector<NUMBER> tau_;
+
+		inline NUMBER& at(std::size_t line, std::size_t column) {
+			return qr_.data()[line * qr_.stride() + column];
+		}
+
+		void reflector(std::size_t k, std::size_t last_column) {
+			// householder reflection of column k, applied to the columns k + 1 .. last_column
+			const std::size_t m = qr_.lines();
+			NUMBER norm = NUMBER();
+			for (std::size_t i = k + 1u; i < m; i++) {
+				norm += at(i, k) * at(i, k);
+			}
+			if (norm == NUMBER()) {
+				tau_[k] = NUMBER();
+				return;
+			}
+			const NUMBER alpha = at(k, k);
+			NUMBER beta = std::sqrt(alpha * alpha + norm);
+			if (NUMBER() < alpha) {
+				beta = -beta;
+			}
+			tau_[k] = (beta - alpha) / beta;
+			const NUMBER scale = static_cast<NUMBER>(1) / (alpha - beta);
+			for (std::size_t i = k + 1u; i < m; i++) {
+				at(i, k) *= scale;
+			}
+			at(k, k) = beta;
+			for (std::size_t j = k + 1u; j < last_column; j++) {
+				NUMBER w = at(k, j);
+				for (std::size_t i = k + 1u; i < m; i++) {
+					w += at(i, k) * at(i, j);
+				}
+				w *= tau_[k];
+				at(k, j) -= w;
+				for (std::size_t i = k + 1u; i < m; i++) {
+					at(i, j) -= w * at(i, k);
+				}
+			}
+		}
+
+		void factorize() {
+			const std::size_t m = qr_.lines();
+			const std::size_t n = qr_.columns();
+			const std::size_t ld = qr_.stride();
+			std::vector<NUMBER> v, vt, t, w;
+			for (std::size_t k0 = 0; k0 < n; k0 += detail::block_size) {
+				const std::size_t kb = std::min(detail::block_size, n - k0);
+				for (std::size_t k = k0; k < k0 + kb; k++) {
+					reflector(k, k0 + kb);
+				}
+				if (k0 + kb == n) {
+					break;
+				}
+				const std::size_t lines = m - k0;
+				const std::size_t rest = n - k0 - kb;
+				// V (lines x kb, unit lower trapezoidal) and V^T
+				v.assign(lines * kb, NUMBER());
+				vt.assign(kb * lines, NUMBER());
+				for (std::size_t i = 0; i < lines; i++) {
+					for (std::size_t p = 0; p < kb && p <= i; p++) {
+						const NUMBER value = i == p ? static_cast<NUMBER>(1) : at(k0 + i, k0 + p);
+						v[i * kb + p] = value;
+						vt[p * lines + i] = value;
+					}
+				}
+				// T (kb x kb upper triangular) : T[i][i] = tau[i], T[0..i][i] = -tau[i] * T[0..i][0..i] * V[:, 0..i]^T * v(i)
+				t.assign(kb * kb, NUMBER());
+				std::vector<NUMBER> product(kb);
+				for (std::size_t i = 0; i < kb; i++) {
+					for (std::size_t p = 0; p < i; p++) {
+						NUMBER sum = NUMBER();
+						for (std::size_t r = i; r < lines; r++) {
+							sum += vt[p * lines + r] * vt[i * lines + r];
+						}
+						product[p] = sum;
+					}
+					for (std::size_t p = 0; p < i; p++) {
+						NUMBER sum = NUMBER();
+						for (std::size_t q = p; q < i; q++) {
+							sum += t[p * kb + q] * product[q];
+						}
+						t[p * kb + i] = -tau_[k0 + i] * sum;
+					}
+					t[i * kb + i] = tau_[k0 + i];
+				}
+				// A2 -= V * T^T * (V^T * A2)
+				NUMBER* a2 = qr_.data() + k0 * ld + k0 + kb;
+				w.assign(kb * rest, NUMBER());
+				math::gemm(kb, rest, lines, static_cast<NUMBER>(1), vt.data(), lines, a2, ld, NUMBER(), w.data(), rest);
+				for (std::size_t i = kb; i-- > 0;) { // w = T^T * w, T^T is lower => bottom to top in place
+					NUMBER* target = w.data() + i * rest;
+					for (std::size_t j = 0; j < rest; j++) {
+						target[j] *= t[i * kb + i];
+					}
+					for (std::size_t p = 0; p < i; p++) {
+						const NUMBER factor = t[p * kb + i];
+						NUMBER const* source = w.data() + p * rest;
+						for (std::size_t j = 0; j < rest; j++) {
+							target[j] += factor * source[j];
+						}
+					}
+				}
+				math::gemm(lines, rest, kb, static_cast<NUMBER>(-1), v.data(), kb, w.data(), rest, static_cast<NUMBER>(1), a2, ld);
+			}
+		}
+
+	public:
+		QR(Matrix2D<NUMBER> const& matrix) : qr_(matrix), tau_(matrix.columns(), NUMBER()) {
+			if (matrix.lines() < matrix.columns()) {
+				error("math::QR::QR", "the matrix must have at least as many lines as columns (" + std::to_string(matrix.lines()) + "x" + std::to_string(matrix.columns()) + ")");
+			}
+			factorize();
+		}
+
+		Matrix2D<NUMBER> R() const { // n x n
+			const std::size_t n = qr_.columns();
+			Matrix2D<NUMBER> result(n, n);
+			for (std::size_t i = 0; i < n; i++) {
+				for (std::size_t j = i; j < n; j++) {
+					result[i][j] = qr_.value(i, j);
+				}
+			}
+			return result;
+		}
+
+		Matrix2D<NUMBER> Q() const { // m x n, orthonormal columns
+			const std::size_t m = qr_.lines();
+			const std::size_t n = qr_.columns();
+			Matrix2D<NUMBER> result(m, n);
+			for (std::size_t i = 0; i < n; i++) {
+				result[i][i] = static_cast<NUMBER>(1);
+			}
+			for (std::size_t k = n; k-- > 0;) {
+				for (std::size_t j = 0; j < n; j++) {
+					NUMBER w = result.value(k, j);
+					for (std::size_t i = k + 1u; i < m; i++) {
+						w += qr_.value(i, k) * result.value(i, j);
+					}
+					w *= tau_[k];
+					result[k][j] -= w;
+					for (std::size_t i = k + 1u; i < m; i++) {
+						result[i][j] -= w * qr_.value(i, k);
+					}
+				}
+			}
+			return result;
+		}
+
+		std::vector<NUMBER> solve(std::vector<NUMBER> const& b) const {
+			// least squares : x minimizing |A * x - b|, exact solution if A is square
+			const std::size_t m = qr_.lines();
+			const std::size_t n = qr_.columns();
+			if (b.size() != m) {
+				error("math::QR::solve", "b.size() (" + std::to_string(b.size()) + ") != " + std::to_string(m));
+			}
+			std::vector<NUMBER> y = b;
+			for (std::size_t k = 0; k < n; k++) { // y = Q^T * b
+				NUMBER w = y[k];
+				for (std::size_t i = k + 1u; i < m; i++) {
+					w += qr_.value(i, k) * y[i];
+				}
+				w *= tau_[k];
+				y[k] -= w;
+				for (std::size_t i = k + 1u; i < m; i++) {
+					y[i] -= w * qr_.value(i, k);
+				}
+			}
+			std::vector<NUMBER> x(n);
+			for (std::size_t i = n; i-- > 0;) { // R * x = y
+				NUMBER value = y[i];
+				for (std::size_t j = i + 1u; j < n; j++) {
+					value -= qr_.value(i, j) * x[j];
+				}
+				if (qr_.value(i, i) == NUMBER()) {
+					error("math::QR::solve", "the matrix doesn't have full rank");
+				}
+				x[i] = value / qr_.value(i, i);
+			}
+			return x;
+		}
+	};
+
+	template<typename NUMBER>
+	inline std::vector<NUMBER> solve(Matrix2D<NUMBER> const& a, std::vector<NUMBER> const& b) {
+		return LU<NUMBER>(a).solve(b);
+	}
+
+	template<typename NUMBER>
+	inline Matrix2D<NUMBER> solve(Matrix2D<NUMBER> const& a, Matrix2D<NUMBER> const& b) {
+		return LU<NUMBER>(a).solve(b);
+	}
+
+	template<typename NUMBER>
+	inline NUMBER determinant(Matrix2D<NUMBER> const& a) {
+		return LU<NUMBER>(a).determinant();
+	}
+
+	template<typename NUMBER>
+	inline Matrix2D<NUMBER> inverse(Matrix2D<NUMBER> const& a) {
+		return LU<NUMBER>(a).inverse();
+	}
+
+	template<typename NUMBER>
+	inline std::vector<NUMBER> least_squares(Matrix2D<NUMBER> const& a, std::vector<NUMBER> const& b) {
+		return QR<NUMBER>(a).solve(b);
+	}
+}
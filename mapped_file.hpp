@@ -0,0 +1,131 @@
+#pragma once
+
+#include "include.hpp"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/*
+read-only memory mapping of a whole file : the pages are read by the system when they are used,
+opening a file of any size costs the same and nothing is copied
+*/
+
+namespace math {
+
+	class MappedFile {
+		char const* data_ = nullptr;
+		std::size_t size_ = 0u;
+#ifdef _WIN32
+		HANDLE file_ = INVALID_HANDLE_VALUE;
+		HANDLE mapping_ = nullptr;
+#endif
+
+		void close() {
+#ifdef _WIN32
+			if (data_ != nullptr) {
+				UnmapViewOfFile(data_);
+			}
+			if (mapping_ != nullptr) {
+				CloseHandle(mapping_);
+			}
+			if (file_ != INVALID_HANDLE_VALUE) {
+				CloseHandle(file_);
+			}
+			file_ = INVALID_HANDLE_VALUE;
+			mapping_ = nullptr;
+#else
+			if (data_ != nullptr) {
+				munmap(const_cast<char*>(data_), size_);
+			}
+#endif
+			data_ = nullptr;
+			size_ = 0u;
+		}
+
+	public:
+		MappedFile() = default;
+
+		MappedFile(std::string const& path) {
+#ifdef _WIN32
+			file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+			if (file_ == INVALID_HANDLE_VALUE) {
+				error("math::MappedFile::MappedFile", "can't open " + path);
+			}
+			LARGE_INTEGER size;
+			GetFileSizeEx(file_, &size);
+			size_ = static_cast<std::size_t>(size.QuadPart);
+			if (size_ != 0u) {
+				mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+				if (mapping_ == nullptr) {
+					error("math::MappedFile::MappedFile", "can't map " + path);
+				}
+				data_ = static_cast<char const*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+				if (data_ == nullptr) {
+					error("math::MappedFile::MappedFile", "can't map " + path);
+				}
+			}
+#else
+			const int file = ::open(path.c_str(), O_RDONLY);
+			if (file < 0) {
+				error("math::MappedFile::MappedFile", "can't open " + path);
+			}
+			struct stat status;
+			if (fstat(file, &status) != 0) {
+				::close(file);
+				error("math::MappedFile::MappedFile", "can't read the size of " + path);
+			}
+			size_ = static_cast<std::size_t>(status.st_size);
+			if (size_ != 0u) { // mmap refuses empty files
+				void* data = mmap(nullptr, size_, PROT_READ, MAP_SHARED, file, 0);
+				if (data == MAP_FAILED) {
+					::close(file);
+					error("math::MappedFile::MappedFile", "can't map " + path);
+				}
+				data_ = static_cast<char const*>(data);
+			}
+			::close(file); // the mapping keeps the file alive
+#endif
+		}
+
+		MappedFile(MappedFile const&) = delete;
+		MappedFile& operator=(MappedFile const&) = delete;
+
+		MappedFile(MappedFile&& file) noexcept {
+			*this = std::move(file);
+		}
+
+		MappedFile& operator=(MappedFile&& file) noexcept {
+			if (this != &file) {
+				close();
+				std::swap(data_, file.data_);
+				std::swap(size_, file.size_);
+#ifdef _WIN32
+				std::swap(file_, file.file_);
+				std::swap(mapping_, file.mapping_);
+#endif
+			}
+			return *this;
+		}
+
+		~MappedFile() {
+			close();
+		}
+
+		inline char const* data() const {
+			return data_;
+		}
+
+		inline std::size_t size() const {
+			return size_;
+		}
+	};
+}
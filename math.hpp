@@ -1,7 +1,16 @@
-#pragma once
-
-#include "include.hpp"
-#include "constants.hpp"
-#include "frac.hpp"
-#include "matrix.hpp"
+#pragma once
+
+#include "include.hpp"
+#include "constants.hpp"
+#include "frac.hpp"
+#include "bigint.hpp"
+#include "memory.hpp"
+#include "matrix.hpp"
+#include "fixed_matrix.hpp"
+#include "batch.hpp"
+#include "frac_array.hpp"
+#include "sparse.hpp"
+#include "linalg.hpp"
+#include "matrix_file.hpp"
+#include "exact.hpp"
 #include "prime.hpp"
\ No newline at end of file
@@ -1,435 +1,1064 @@
-#pragma once
-
-#include "include.hpp"
-
-enum class matrix_mode { GRID, SPACE, GRID_SPACE };
-
-// GRID :
-/*
-|4  |5 |8|
-|11 |88|
-|400|2 |
-*/
-
-
-namespace math {
-
-	template<typename NUMBER>
-	class Matrix2D {
-		std::vector<std::vector<NUMBER>> vals_ = std::vector<std::vector<NUMBER>>();
-		mutable matrix_mode output_ = matrix_mode::SPACE;
-
-		void clean() {
-			/*
-			transforms vals_ into a square and fills new boxes by NUMBER()
-			ex:
-			2 2
-			3 3 3
-			4
-			5 5 5 5
-
-			=>
-
-			2 2 0 0
-			3 3 3 0
-			4 0 0 0
-			5 5 5 5
-			*/
-			std::size_t final_length = 0u; // max size of a line
-			for (std::vector<NUMBER> const& line : vals_) {
-				final_length = std::max(final_length, line.size());
-			}
-			for (std::vector<NUMBER>& line : vals_) {
-				if (line.size() < final_length) {
-					line.reserve(final_length - line.size());
-					for (std::size_t i = line.size(); i < final_length; i++) {
-						line.push_back(NUMBER());
-					}
-				}
-			}
-		}
-
-	public:
-		Matrix2D(std::size_t lines = 2u, std::size_t columns = 2u) {
-			vals_.reserve(lines);
-			for (std::size_t line = 0; line < lines; line++) {
-				vals_.push_back(std::vector<NUMBER>());
-			}
-			for (std::vector<NUMBER>& line : vals_) {
-				line.reserve(columns);
-				for (NUMBER& val : line) {
-					val = NUMBER();
-				}
-			}
-			for (std::vector<NUMBER>& line : vals_) {
-				math::reduce_number(line);
-			}
-			clean();
-		}
-
-		Matrix2D(std::size_t lines, std::vector<NUMBER> const& line) {
-			vals_.reserve(lines);
-			for (std::size_t i = 0; i < lines; i++) {
-				vals_.push_back(line);
-			}
-			for (std::vector<NUMBER>& line : vals_) {
-				math::reduce_number(line);
-			}
-			clean();
-		}
-
-		Matrix2D(std::vector<std::vector<NUMBER>> const& vals) {
-			vals_ = vals;
-			for (std::vector<NUMBER>& line : vals_) {
-				math::reduce_number(line);
-			}
-			clean();
-		}
-
-		void fill_column(std::size_t column, NUMBER value) { // DON'T throws error if column out of range => because columns's lengthes may be unequal
-			for (std::vector<NUMBER>& line : vals_) {
-				if (column < line.size()) {
-					line[column] = value;
-				}
-			}
-			for (std::vector<NUMBER>& line : vals_) {
-				math::reduce_number(line);
-			}
-			clean();
-		}
-
-		void fill_line(std::size_t line, NUMBER value) { // THROWS error if line out of range
-			if (line >= vals_.size()) {
-				error("math::Matrix2D::fill_line", "line index out of bounds !");
-			}
-			std::fill(vals_[line].begin(), vals_[line].end(), value);
-			for (std::vector<NUMBER>& line : vals_) {
-				math::reduce_number(line);
-			}
-			clean();
-		}
-
-		void fill(NUMBER value) {
-			for (std::size_t line = 0; line < vals_.size(); line++) {
-				fill_line(line, value);
-			}
-			for (std::vector<NUMBER>& line : vals_) {
-				math::reduce_number(line);
-			}
-			clean();
-		}
-
-		inline std::size_t lines() const {
-			return vals_.size();
-		}
-
-		inline std::size_t min_columns() const {
-			// returns the size of the smallest line
-			std::size_t result = 0;
-			for (std::vector<NUMBER> const& line : vals_) {
-				result = std::min(result, line.size());
-			}
-			return result;
-		}
-
-		inline std::size_t max_columns() const {
-			// returns the size of the biggest line
-			std::size_t result = 0;
-			for (std::vector<NUMBER> const& line : vals_) {
-				result = std::max(result, line.size());
-			}
-			return result;
-		}
-
-		std::vector<NUMBER>& operator[](std::size_t index) {
-			if (index >= vals_.size()) {
-				error("math::Matrix2D::operator[]", "index (" + std::to_string(index) + ") >= vals_.size()");
-			}
-			return vals_[index];
-		}
-
-		const std::vector<NUMBER> operator[](std::size_t index) const {
-			if (index >= vals_.size()) {
-				error("math::Matrix2D::operator[]", "index (" + std::to_string(index) + ") >= vals_.size()");
-			}
-			return vals_[index];
-		}
-
-		void push_line(std::vector<NUMBER> const& line) {
-			vals_.push_back(line);
-			for (std::vector<NUMBER>& line : vals_) {
-				math::reduce_number(line);
-			}
-			clean();
-		}
-
-		void push_column(std::vector<NUMBER> const& column) { 
-			/* if column's size is > number of lines, we stop when we are t the end of the lines
-			1 1 2
-			5 9 6
-			7 8 9
-			=> push_column({0, 1, 2, 3, 4})
-			1 1 2 0
-			5 9 6 1
-			7 8 9 3
-			end
-			*/
-			for (std::size_t i = 0; i < vals_.size(); i++) {
-				if (i >= column.size()) { // column's size < number of lines
-					return 0;
-				}
-				vals_[i].push_back(column[i]);
-			}
-			for (std::vector<NUMBER>& line : vals_) {
-				math::reduce_number(line);
-			}
-			clean();
-		}
-
-		void insert_line(std::size_t index, std::vector<NUMBER> const& line) { // if index >= vals_.size => insert at the end
-			if (index >= vals_.size()) {
-				vals_.push_back(line);
-				return;
-			}
-			vals_.insert(index, line);
-			for (std::vector<NUMBER>& line : vals_) {
-				math::reduce_number(line);
-			}
-			clean();
-		}
-
-		void insert_column(std::size_t index, std::vector<NUMBER> const& column) { // if index >= line.size => insert at the end; if column's size > number of line, stop when at the end of the lines
-			for (std::size_t i = 0; i < vals_.size(); i++) {
-				if (i >= column.size()) {
-					return;
-				}
-				if (index >= vals_[i].size()) {
-					vals_[i].push_back(column[i]);
-					continue;
-				}
-				vals_[i].insert(index, column[i]);
-			}
-			for (std::vector<NUMBER>& line : vals_) {
-				math::reduce_number(line);
-			}
-			clean();
-		}
-
-		void reset() {
-			vals_ = std::vector<std::vector<NUMBER>>();
-			for (std::vector<NUMBER>& line : vals_) {
-				math::reduce_number(line);
-			}
-			clean();
-		}
-
-		void remove_value(NUMBER value) {
-			std::vector<NUMBER> new_line;
-			for (std::size_t i = 0; i < vals_.size(); i++) {
-				for (NUMBER val : vals_[i]) {
-					new_line.reserve(vals_[i].size());
-					if (val != value) {
-						new_line.push_back(val);
-					}
-				}
-				vals_[i] = new_line;
-				new_line = std::vector<NUMBER>();
-			}
-			for (std::vector<NUMBER>& line : vals_) {
-				math::reduce_number(line);
-			}
-			clean();
-		}
-
-		void replace_value(NUMBER old_value, NUMBER new_value) {
-			std::vector<NUMBER> new_line;
-			for (std::size_t i = 0; i < vals_.size(); i++) {
-				for (NUMBER val : vals_[i]) {
-					new_line.reserve(vals_[i].size());
-					if (val != old_value) {
-						new_line.push_back(val);
-					}
-					else {
-						new_line.push_back(new_value);
-					}
-				}
-				vals_[i] = new_line;
-				new_line = std::vector<NUMBER>();
-			}
-			for (std::vector<NUMBER>& line : vals_) {
-				math::reduce_number(line);
-			}
-			clean();
-		}
-
-		void swap_lines(std::size_t first_line, std::size_t second_line) {
-			if (first_line >= vals_.size()) {
-				error("math::Matrix2D::swap_lines", "first_line index is out of range");
-			}
-			if (second_line >= vals_.size()) {
-				error("math::Matrix2D::swap_lines", "second_line index is out of range");
-			}
-			std::iter_swap(vals_.begin() + first_line, vals_.begin() + second_line);
-			for (std::vector<NUMBER>& line : vals_) {
-				math::reduce_number(line);
-			}
-			clean();
-		}
-
-		void swap_columns(std::size_t first_column, std::size_t second_column) {
-			/*
-			7 8 9
-			4 5
-			7 8 9 6 5
-			1 2 3
-			=> swap_columns(1, 3)
-			7 8 9
-			4 5
-			7 6 9 8 5
-			1 2 3
-			=> swaps ONLY if the line is able to do it
-			*/
-			for (std::vector<NUMBER>& line : vals_) {
-				if (std::max(first_column, second_column) < line.size()) { // can swap
-					std::iter_swap(line.begin() + first_column, line.begin() + second_column);
-				}
-			}
-			for (std::vector<NUMBER>& line : vals_) {
-				math::reduce_number(line);
-			}
-			clean();
-		}
-
-		NUMBER line_sum(std::size_t index) const {
-			if (index >+ vals_.size()) {
-				error("math::Matrix2D::line_sum", "index is out of range !");
-			}
-			return std::accumulate(vals_[index]);
-		}
-
-		NUMBER column_sum(std::size_t column) const { // if line's size < column's index => does nothing
-			NUMBER result = NUMBER();
-			for (std::vector<NUMBER> const& line : vals_) {
-				if (column < line.size()) {
-					result += line[column];
-				}
-			}
-			return result;
-		}
-
-		NUMBER sum() const {
-			NUMBER result = NUMBER();
-			for (std::vector<NUMBER> const& line : vals_) {
-				result += std::accumulate(line.begin(), line.end());
-			}
-			return result;
-		}
-
-		void remove_line(std::size_t index) {
-			if (index >= vals_.size()) {
-				error("math::Matrix2D::remove_line", "index of the line to remove is out of range !");
-			}
-			vals_.erase(vals_.begin(), vals_.begin() + index);
-			for (std::vector<NUMBER>& line : vals_) {
-				math::reduce_number(line);
-			}
-			clean();
-		}
-
-		void remove_column(std::size_t index) { // if column is out of range in certain lines, DOESN'T throw error => does nothing
-			for (std::vector<NUMBER>& line : vals_) {
-				if (index < line.size()) {
-					line.erase(line.begin() + index); // erases the (index)th value
-				}
-			}
-			for (std::vector<NUMBER>& line : vals_) {
-				math::reduce_number(line);
-			}
-			clean();
-		}
-
-		std::vector<std::vector<NUMBER>> vals() const {
-			return vals_;
-		}
-
-		void output_mode(matrix_mode mode) const {
-			output_ = mode;
-		}
-
-		matrix_mode output_mode() const {
-			return output_;
-		}
-
-		std::size_t max_val_size_line(std::size_t line) const {
-			// returns the max number of digits of a number in a line
-			if (line >= vals_.size()) {
-				error("math::Matrix2D::max_val_size_line", "line index out of range");
-			}
-			std::size_t result = 0u;
-			for (NUMBER val : vals_[line]) {
-				result = std::max(result, math::reduce_number(std::string(val)).size());
-			}
-			return result;
-		}
-
-		std::size_t max_val_size_column(std::size_t column) const { // used by std::ostream& operator<<
-			// returns the max number of digits of a number in a column => doesn't throw error, if out of range => does nothing
-			std::size_t result = 0u;
-			for (std::vector<NUMBER> const& line : vals_) {
-				if (column < line.size()) {
-					result = std::max(result, std::to_string(line[column]).size());
-				}
-			}
-			return result;
-		}
-
-	};
-
-	typedef math::Matrix2D<int> IMatrix2D;
-	typedef math::Matrix2D<float> FMatrix2D;
-	typedef math::Matrix2D<long long int> LIMatrix2D;
-	typedef math::Matrix2D<long double> LFMatrix2D;
-}
-
-
-
-template<typename NUMBER>
-std::ostream& operator<<(std::ostream& stream, math::Matrix2D<NUMBER> const& matrix) {
-	std::vector<NUMBER> copy;
-	std::string separator;
-	switch (matrix.output_mode()) {
-	case matrix_mode::GRID:
-		separator = "|";
-		break;
-	case matrix_mode::SPACE:
-		separator = " ";
-		break;
-	default:
-		separator = " | ";
-		break;
-	}
-	const std::vector<std::vector<NUMBER>> vals_ = matrix.vals();
-	for (std::size_t line = 0; line < vals_.size(); line++) {
-		copy = vals_[line];
-		math::reduce_number<NUMBER>(copy);
-		for (std::size_t i = 0; i < copy.size(); i++) {
-			stream << copy[i];
-			for (std::size_t j = math::reduce_number(copy[i]).size(); j < matrix.max_val_size_column(i); j++) {
-				stream << " ";
-			}
-			if (i != copy.size() - 1) {
-				stream << separator;
-			}
-		}
-		if (line < (vals_.size() - 1)) {
-			stream << std::endl;
-		}
-	}
-	return stream;	
-}
-
-#ifndef DISABLE_MATRIX_TYPES
-constexpr matrix_mode SPACE = matrix_mode::SPACE;
-constexpr matrix_mode GRID = matrix_mode::GRID;
-constexpr matrix_mode GRID_SPACE = matrix_mode::GRID_SPACE;
+#pragma once
+
+#include "include.hpp"
+#include "utils.hpp"
+#include "gemm.hpp"
+#include "matrix_expr.hpp"
+#include "reduce.hpp"
+#include "memory.hpp"
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+
+enum class matrix_mode { GRID, SPACE, GRID_SPACE };
+
+// GRID :
+/*
+|4  |5 |8|
+|11 |88|
+|400|2 |
+*/
+
+
+namespace math {
+
+	template<typename T>
+	class MatrixLine {
+		// non-owning view of one line of a Matrix2D, T is NUMBER or const NUMBER
+		T* data_ = nullptr;
+		std::size_t size_ = 0u;
+
+	public:
+		MatrixLine(T* data, std::size_t size) : data_(data), size_(size) {}
+
+		inline T& operator[](std::size_t index) const {
+			return data_[index];
+		}
+
+		inline std::size_t size() const {
+			return size_;
+		}
+
+		inline T* data() const {
+			return data_;
+		}
+
+		inline T* begin() const {
+			return data_;
+		}
+
+		inline T* end() const {
+			return data_ + size_;
+		}
+
+		MatrixLine const& operator=(std::vector<typename std::remove_const<T>::type> const& line) const { // missing values are filled by NUMBER()
+			if (line.size() > size_) {
+				error("math::MatrixLine::operator=", "line is longer than the matrix (" + std::to_string(line.size()) + " > " + std::to_string(size_) + ")");
+			}
+			std::copy(line.begin(), line.end(), data_);
+			std::fill(data_ + line.size(), data_ + size_, typename std::remove_const<T>::type());
+			return *this;
+		}
+
+		operator std::vector<typename std::remove_const<T>::type>() const {
+			return std::vector<typename std::remove_const<T>::type>(data_, data_ + size_);
+		}
+	};
+
+	template<typename T>
+	class MatrixColumn {
+		// non-owning view of one column of a Matrix2D : size values, stride values apart
+		T* data_ = nullptr;
+		std::size_t size_ = 0u;
+		std::size_t stride_ = 0u;
+
+	public:
+		class iterator {
+			T* position_;
+			std::size_t stride_;
+
+		public:
+			typedef std::forward_iterator_tag iterator_category;
+			typedef typename std::remove_const<T>::type value_type;
+			typedef std::ptrdiff_t difference_type;
+			typedef T* pointer;
+			typedef T& reference;
+
+			iterator(T* position, std::size_t stride) : position_(position), stride_(stride) {}
+
+			inline T& operator*() const {
+				return *position_;
+			}
+
+			inline iterator& operator++() {
+				position_ += stride_;
+				return *this;
+			}
+
+			inline iterator operator++(int) {
+				iterator copy = *this;
+				position_ += stride_;
+				return copy;
+			}
+
+			inline bool operator==(iterator const& other) const {
+				return position_ == other.position_;
+			}
+
+			inline bool operator!=(iterator const& other) const {
+				return position_ != other.position_;
+			}
+		};
+
+		MatrixColumn(T* data, std::size_t size, std::size_t stride) : data_(data), size_(size), stride_(stride) {}
+
+		inline T& operator[](std::size_t index) const {
+			return data_[index * stride_];
+		}
+
+		inline std::size_t size() const {
+			return size_;
+		}
+
+		inline std::size_t stride() const {
+			return stride_;
+		}
+
+		inline iterator begin() const {
+			return iterator(data_, stride_);
+		}
+
+		inline iterator end() const {
+			return iterator(data_ + size_ * stride_, stride_);
+		}
+
+		MatrixColumn const& operator=(std::vector<typename std::remove_const<T>::type> const& column) const { // missing values are filled by NUMBER()
+			if (column.size() > size_) {
+				error("math::MatrixColumn::operator=", "column is longer than the matrix (" + std::to_string(column.size()) + " > " + std::to_string(size_) + ")");
+			}
+			for (std::size_t i = 0; i < size_; i++) {
+				data_[i * stride_] = i < column.size() ? column[i] : typename std::remove_const<T>::type();
+			}
+			return *this;
+		}
+
+		operator std::vector<typename std::remove_const<T>::type>() const {
+			return std::vector<typename std::remove_const<T>::type>(begin(), end());
+		}
+	};
+
+	template<typename T>
+	class MatrixView : public MatrixExpression<MatrixView<T>> {
+		/*
+		non-owning view of a rectangle of a Matrix2D, T is NUMBER or const NUMBER
+		the view is only valid as long as the matrix isn't resized
+		*/
+		T* data_ = nullptr;
+		std::size_t lines_ = 0u;
+		std::size_t columns_ = 0u;
+		std::size_t stride_ = 0u;
+
+	public:
+		typedef typename std::remove_const<T>::type number_type;
+
+		MatrixView(T* data, std::size_t lines, std::size_t columns, std::size_t stride) : data_(data), lines_(lines), columns_(columns), stride_(stride) {}
+
+		inline std::size_t lines() const {
+			return lines_;
+		}
+
+		inline std::size_t columns() const {
+			return columns_;
+		}
+
+		inline std::size_t stride() const {
+			return stride_;
+		}
+
+		inline T* data() const {
+			return data_;
+		}
+
+		inline T& value(std::size_t line, std::size_t column) const { // no bounds checking
+			return data_[line * stride_ + column];
+		}
+
+		MatrixLine<T> operator[](std::size_t index) const {
+			if (index >= lines_) {
+				error("math::MatrixView::operator[]", "index (" + std::to_string(index) + ") >= lines()");
+			}
+			return MatrixLine<T>(data_ + index * stride_, columns_);
+		}
+
+		MatrixColumn<T> column(std::size_t index) const {
+			if (index >= columns_) {
+				error("math::MatrixView::column", "index (" + std::to_string(index) + ") >= columns()");
+			}
+			return MatrixColumn<T>(data_ + index, lines_, stride_);
+		}
+
+		MatrixView submatrix(std::size_t line, std::size_t column, std::size_t lines, std::size_t columns) const {
+			if (line + lines > lines_ || column + columns > columns_) {
+				error("math::MatrixView::submatrix", "the submatrix goes out of the view");
+			}
+			return MatrixView(data_ + line * stride_ + column, lines, columns, stride_);
+		}
+
+		Matrix2D<number_type> to_matrix2d() const {
+			return Matrix2D<number_type>(*this);
+		}
+	};
+
+	namespace detail {
+
+		constexpr std::size_t transpose_leaf = 32u; // blocks up to 32x32 are transposed directly
+
+		template<typename NUMBER>
+		void transpose(NUMBER const* source, std::size_t source_stride, NUMBER* target, std::size_t target_stride, std::size_t lines, std::size_t columns) {
+			// cache-oblivious : the biggest dimension is cut in 2 until the blocks fit in the cache, whatever its size
+			if (lines <= transpose_leaf && columns <= transpose_leaf) {
+				for (std::size_t i = 0; i < lines; i++) {
+					for (std::size_t j = 0; j < columns; j++) {
+						target[j * target_stride + i] = source[i * source_stride + j];
+					}
+				}
+			}
+			else if (lines >= columns) {
+				const std::size_t half = lines / 2u;
+				detail::transpose(source, source_stride, target, target_stride, half, columns);
+				detail::transpose(source + half * source_stride, source_stride, target + half, target_stride, lines - half, columns);
+			}
+			else {
+				const std::size_t half = columns / 2u;
+				detail::transpose(source, source_stride, target, target_stride, lines, half);
+				detail::transpose(source + half, source_stride, target + half * target_stride, target_stride, lines, columns - half);
+			}
+		}
+
+		template<typename NUMBER>
+		void swap_transposed(NUMBER* a, NUMBER* b, std::size_t stride, std::size_t lines, std::size_t columns) {
+			// swaps a[i][j] and b[j][i], a and b don't overlap
+			if (lines <= transpose_leaf && columns <= transpose_leaf) {
+				for (std::size_t i = 0; i < lines; i++) {
+					for (std::size_t j = 0; j < columns; j++) {
+						std::swap(a[i * stride + j], b[j * stride + i]);
+					}
+				}
+			}
+			else if (lines >= columns) {
+				const std::size_t half = lines / 2u;
+				detail::swap_transposed(a, b, stride, half, columns);
+				detail::swap_transposed(a + half * stride, b + half, stride, lines - half, columns);
+			}
+			else {
+				const std::size_t half = columns / 2u;
+				detail::swap_transposed(a, b, stride, lines, half);
+				detail::swap_transposed(a + half, b + half * stride, stride, lines, columns - half);
+			}
+		}
+
+		template<typename NUMBER>
+		void transpose_square(NUMBER* data, std::size_t stride, std::size_t size) {
+			// transposes the 2 diagonal blocks then swaps the 2 others
+			if (size <= transpose_leaf) {
+				for (std::size_t i = 0; i < size; i++) {
+					for (std::size_t j = i + 1u; j < size; j++) {
+						std::swap(data[i * stride + j], data[j * stride + i]);
+					}
+				}
+				return;
+			}
+			const std::size_t half = size / 2u;
+			detail::transpose_square(data, stride, half);
+			detail::transpose_square(data + half * stride + half, stride, size - half);
+			detail::swap_transposed(data + half, data + half * stride, stride, half, size - half);
+		}
+	}
+
+	template<typename NUMBER>
+	struct MatrixAggregates { // returned by Matrix2D::aggregates()
+		NUMBER sum = NUMBER();
+		NUMBER min = NUMBER();
+		NUMBER max = NUMBER();
+		NUMBER mean = NUMBER();
+		std::vector<NUMBER> line_sums;
+		std::vector<NUMBER> column_sums;
+	};
+
+	template<typename NUMBER, typename ALLOCATOR>
+	class Matrix2D : public MatrixExpression<Matrix2D<NUMBER, ALLOCATOR>> {
+	public:
+		typedef NUMBER number_type;
+		typedef ALLOCATOR allocator_type;
+
+	private:
+		/*
+		values are stored line after line in a single buffer :
+		line i starts at vals_[i * stride_], only the first columns_ values of a line are used,
+		the others are kept to NUMBER() and let push_column / insert_column grow without moving everything
+		the buffer comes from ALLOCATOR, see math::pmr::Matrix2D to put it in a math::MatrixArena or a math::MatrixPool
+		*/
+		std::vector<NUMBER, ALLOCATOR> vals_;
+		std::size_t lines_ = 0u;
+		std::size_t columns_ = 0u;
+		std::size_t stride_ = 0u;
+		bool normalized_ = true; // false when a value may not have been through math::reduce_number yet
+		mutable matrix_mode output_ = matrix_mode::SPACE;
+
+		void reserve_columns(std::size_t columns) {
+			// makes room for at least columns values per line, moves every line once
+			if (columns <= stride_) {
+				return;
+			}
+			const std::size_t new_stride = std::max(columns, stride_ * 2u);
+			std::vector<NUMBER, ALLOCATOR> new_vals(lines_ * new_stride, NUMBER(), vals_.get_allocator());
+			for (std::size_t line = 0; line < lines_; line++) {
+				std::copy(vals_.begin() + line * stride_, vals_.begin() + line * stride_ + columns_, new_vals.begin() + line * new_stride);
+			}
+			vals_.swap(new_vals);
+			stride_ = new_stride;
+		}
+
+		void resize_columns(std::size_t columns) {
+			// new boxes are filled by NUMBER()
+			reserve_columns(columns);
+			columns_ = std::max(columns_, columns);
+		}
+
+		inline std::size_t lines_per_block() const { // a reduction task reads about detail::reduction_block values
+			return std::max<std::size_t>(1u, detail::reduction_block / std::max<std::size_t>(1u, columns_));
+		}
+
+		inline std::size_t line_blocks() const {
+			return (lines_ + lines_per_block() - 1u) / lines_per_block();
+		}
+
+		template<typename COMPARE>
+		NUMBER extremum(COMPARE const& better) const {
+			// better(a, b) == true when b has to replace a
+			if (lines_ == 0u || columns_ == 0u) {
+				return NUMBER();
+			}
+			std::vector<NUMBER> partials(line_blocks());
+			math::parallel_for(partials.size(), [&](std::size_t block) {
+				const std::size_t first = block * lines_per_block();
+				const std::size_t last = std::min(lines_, first + lines_per_block());
+				NUMBER result = line_data(first)[0];
+				for (std::size_t line = first; line < last; line++) {
+					for (std::size_t column = 0; column < columns_; column++) {
+						result = better(result, line_data(line)[column]) ? line_data(line)[column] : result;
+					}
+				}
+				partials[block] = result;
+			});
+			NUMBER result = partials[0];
+			for (NUMBER const& partial : partials) {
+				result = better(result, partial) ? partial : result;
+			}
+			return result;
+		}
+
+		inline NUMBER* line_data(std::size_t line) {
+			return vals_.data() + line * stride_;
+		}
+
+		inline NUMBER const* line_data(std::size_t line) const {
+			return vals_.data() + line * stride_;
+		}
+
+	public:
+		Matrix2D(std::size_t lines = 2u, std::size_t columns = 2u, ALLOCATOR const& allocator = ALLOCATOR()) : vals_(lines * columns, NUMBER(), allocator), lines_(lines), columns_(columns), stride_(columns) {}
+
+		Matrix2D(std::size_t lines, std::vector<NUMBER> const& line, ALLOCATOR const& allocator = ALLOCATOR()) : vals_(allocator), lines_(lines), columns_(line.size()), stride_(line.size()) {
+			vals_.reserve(lines * line.size());
+			for (std::size_t i = 0; i < lines; i++) {
+				vals_.insert(vals_.end(), line.begin(), line.end());
+			}
+			normalized_ = false;
+		}
+
+		Matrix2D(std::vector<std::vector<NUMBER>> const& vals, ALLOCATOR const& allocator = ALLOCATOR()) : vals_(allocator), lines_(vals.size()) {
+			for (std::vector<NUMBER> const& line : vals) {
+				columns_ = std::max(columns_, line.size());
+			}
+			stride_ = columns_;
+			vals_.assign(lines_ * stride_, NUMBER());
+			for (std::size_t i = 0; i < lines_; i++) {
+				std::copy(vals[i].begin(), vals[i].end(), line_data(i));
+			}
+			normalized_ = false;
+		}
+
+		template<typename E>
+		Matrix2D(MatrixExpression<E> const& expr, ALLOCATOR const& allocator = ALLOCATOR()) : vals_(allocator) {
+			assign(expr.self());
+		}
+
+		template<typename E>
+		Matrix2D& operator=(MatrixExpression<E> const& expr) {
+			assign(expr.self());
+			return *this;
+		}
+
+		template<typename E>
+		Matrix2D& operator+=(MatrixExpression<E> const& expr) {
+			return *this = *this + expr;
+		}
+
+		template<typename E>
+		Matrix2D& operator-=(MatrixExpression<E> const& expr) {
+			return *this = *this - expr;
+		}
+
+		Matrix2D& operator*=(NUMBER factor) {
+			return *this = *this * factor;
+		}
+
+		Matrix2D& operator/=(NUMBER divisor) {
+			return *this = *this / divisor;
+		}
+
+		template<typename E>
+		void assign(E const& expr) {
+			/*
+			evaluates an expression in one pass
+			same shape : written in place, expressions are elementwise and a view of *this with the same shape is *this itself
+			other shape : expr may read a view of *this => evaluated in a new buffer, swapped in at the end
+			*/
+			if (expr.lines() != lines_ || expr.columns() != columns_) {
+				std::vector<NUMBER, ALLOCATOR> new_vals(vals_.get_allocator());
+				new_vals.reserve(expr.lines() * expr.columns());
+				for (std::size_t line = 0; line < expr.lines(); line++) {
+					for (std::size_t column = 0; column < expr.columns(); column++) {
+						new_vals.push_back(static_cast<NUMBER>(expr.value(line, column)));
+					}
+				}
+				vals_.swap(new_vals);
+				lines_ = expr.lines();
+				columns_ = expr.columns();
+				stride_ = columns_;
+				normalized_ = false;
+				return;
+			}
+			for (std::size_t line = 0; line < lines_; line++) {
+				NUMBER* values = line_data(line);
+				for (std::size_t column = 0; column < columns_; column++) {
+					values[column] = static_cast<NUMBER>(expr.value(line, column));
+				}
+			}
+			normalized_ = false;
+		}
+
+		inline NUMBER const& value(std::size_t line, std::size_t column) const { // no bounds checking
+			return vals_[line * stride_ + column];
+		}
+
+		void fill_column(std::size_t column, NUMBER value) { // DON'T throws error if column out of range
+			if (column < columns_) {
+				for (std::size_t line = 0; line < lines_; line++) {
+					line_data(line)[column] = value;
+				}
+			}
+			normalized_ = false;
+		}
+
+		void fill_line(std::size_t line, NUMBER value) { // THROWS error if line out of range
+			if (line >= lines_) {
+				error("math::Matrix2D::fill_line", "line index out of bounds !");
+			}
+			std::fill(line_data(line), line_data(line) + columns_, value);
+			normalized_ = false;
+		}
+
+		void fill(NUMBER value) {
+			for (std::size_t line = 0; line < lines_; line++) {
+				std::fill(line_data(line), line_data(line) + columns_, value);
+			}
+			normalized_ = false;
+		}
+
+		void normalize() {
+			// reduces every value through math::reduce_number, only does the work once after a batch of edits
+			if (normalized_) {
+				return;
+			}
+			math::reduce_number(vals_);
+			normalized_ = true;
+		}
+
+		inline bool normalized() const {
+			return normalized_;
+		}
+
+		inline ALLOCATOR get_allocator() const {
+			return vals_.get_allocator();
+		}
+
+		inline std::size_t lines() const {
+			return lines_;
+		}
+
+		inline std::size_t columns() const {
+			return columns_;
+		}
+
+		inline std::size_t stride() const {
+			// distance between the beginning of two lines in data()
+			return stride_;
+		}
+
+		inline NUMBER* data() { // values written through data() may not be reduced
+			normalized_ = false;
+			return vals_.data();
+		}
+
+		inline NUMBER const* data() const {
+			return vals_.data();
+		}
+
+		inline std::size_t min_columns() const {
+			// every line has the same size since short lines are filled by NUMBER()
+			return columns_;
+		}
+
+		inline std::size_t max_columns() const {
+			return columns_;
+		}
+
+		MatrixLine<NUMBER> operator[](std::size_t index) {
+			if (index >= lines_) {
+				error("math::Matrix2D::operator[]", "index (" + std::to_string(index) + ") >= lines()");
+			}
+			normalized_ = false; // the line may be written through the view
+			return MatrixLine<NUMBER>(line_data(index), columns_);
+		}
+
+		MatrixLine<const NUMBER> operator[](std::size_t index) const { // no copy, converts to std::vector<NUMBER> if needed
+			if (index >= lines_) {
+				error("math::Matrix2D::operator[]", "index (" + std::to_string(index) + ") >= lines()");
+			}
+			return MatrixLine<const NUMBER>(line_data(index), columns_);
+		}
+
+		MatrixColumn<NUMBER> column(std::size_t index) {
+			if (index >= columns_) {
+				error("math::Matrix2D::column", "index (" + std::to_string(index) + ") >= columns()");
+			}
+			normalized_ = false; // the column may be written through the view
+			return MatrixColumn<NUMBER>(vals_.data() + index, lines_, stride_);
+		}
+
+		MatrixColumn<const NUMBER> column(std::size_t index) const {
+			if (index >= columns_) {
+				error("math::Matrix2D::column", "index (" + std::to_string(index) + ") >= columns()");
+			}
+			return MatrixColumn<const NUMBER>(vals_.data() + index, lines_, stride_);
+		}
+
+		MatrixView<NUMBER> view() {
+			normalized_ = false;
+			return MatrixView<NUMBER>(vals_.data(), lines_, columns_, stride_);
+		}
+
+		MatrixView<const NUMBER> view() const {
+			return MatrixView<const NUMBER>(vals_.data(), lines_, columns_, stride_);
+		}
+
+		MatrixView<NUMBER> submatrix(std::size_t line, std::size_t column, std::size_t lines, std::size_t columns) {
+			return view().submatrix(line, column, lines, columns);
+		}
+
+		MatrixView<const NUMBER> submatrix(std::size_t line, std::size_t column, std::size_t lines, std::size_t columns) const {
+			return view().submatrix(line, column, lines, columns);
+		}
+
+		Matrix2D transpose() const {
+			Matrix2D result(columns_, lines_, vals_.get_allocator());
+			detail::transpose(vals_.data(), stride_, result.vals_.data(), result.stride_, lines_, columns_);
+			result.normalized_ = normalized_;
+			return result;
+		}
+
+		void transpose_in_place() {
+			// square matrices are transposed without any copy, the others go through a new buffer
+			if (lines_ == columns_) {
+				detail::transpose_square(vals_.data(), stride_, lines_);
+			}
+			else {
+				*this = transpose();
+			}
+		}
+
+		void push_line(std::vector<NUMBER> const& line) {
+			insert_line(lines_, line);
+		}
+
+		void push_column(std::vector<NUMBER> const& column) { 
+			/* if column's size is > number of lines, we stop when we are t the end of the lines
+			1 1 2
+			5 9 6
+			7 8 9
+			=> push_column({0, 1, 2, 3, 4})
+			1 1 2 0
+			5 9 6 1
+			7 8 9 3
+			end
+			*/
+			insert_column(columns_, column);
+		}
+
+		void insert_line(std::size_t index, std::vector<NUMBER> const& line) { // if index >= lines() => insert at the end
+			index = std::min(index, lines_);
+			resize_columns(line.size());
+			vals_.insert(vals_.begin() + index * stride_, stride_, NUMBER());
+			lines_++;
+			std::copy(line.begin(), line.end(), line_data(index));
+			normalized_ = false;
+		}
+
+		void insert_column(std::size_t index, std::vector<NUMBER> const& column) { // if index >= columns() => insert at the end; if column's size > number of line, stop when at the end of the lines
+			index = std::min(index, columns_);
+			reserve_columns(columns_ + 1u);
+			for (std::size_t line = 0; line < lines_; line++) {
+				NUMBER* values = line_data(line);
+				std::copy_backward(values + index, values + columns_, values + columns_ + 1u);
+				values[index] = line < column.size() ? column[line] : NUMBER();
+			}
+			columns_++;
+			normalized_ = false;
+		}
+
+		void reset() {
+			vals_.clear();
+			vals_.shrink_to_fit();
+			lines_ = 0u;
+			columns_ = 0u;
+			stride_ = 0u;
+			normalized_ = true;
+		}
+
+		void remove_value(NUMBER value) {
+			// removed values are shifted to the end of their line and replaced by NUMBER()
+			// moving values around doesn't change their reduced form => normalized_ is kept
+			std::size_t new_columns = 0u;
+			for (std::size_t line = 0; line < lines_; line++) {
+				NUMBER* values = line_data(line);
+				NUMBER* last = std::remove(values, values + columns_, value);
+				std::fill(last, values + columns_, NUMBER());
+				new_columns = std::max(new_columns, static_cast<std::size_t>(last - values));
+			}
+			columns_ = new_columns;
+		}
+
+		void replace_value(NUMBER old_value, NUMBER new_value) {
+			for (std::size_t line = 0; line < lines_; line++) {
+				std::replace(line_data(line), line_data(line) + columns_, old_value, new_value);
+			}
+			normalized_ = false;
+		}
+
+		void swap_lines(std::size_t first_line, std::size_t second_line) {
+			if (first_line >= lines_) {
+				error("math::Matrix2D::swap_lines", "first_line index is out of range");
+			}
+			if (second_line >= lines_) {
+				error("math::Matrix2D::swap_lines", "second_line index is out of range");
+			}
+			if (first_line != second_line) {
+				std::swap_ranges(line_data(first_line), line_data(first_line) + columns_, line_data(second_line));
+			}
+		}
+
+		void swap_columns(std::size_t first_column, std::size_t second_column) {
+			/*
+			7 8 9
+			4 5 0
+			7 8 9
+			=> swap_columns(0, 2)
+			9 8 7
+			0 5 4
+			9 8 7
+			=> does nothing if a column is out of range
+			*/
+			if (std::max(first_column, second_column) < columns_) { // can swap
+				for (std::size_t line = 0; line < lines_; line++) {
+					std::swap(line_data(line)[first_column], line_data(line)[second_column]);
+				}
+			}
+		}
+
+		NUMBER line_sum(std::size_t index) const {
+			if (index >= lines_) {
+				error("math::Matrix2D::line_sum", "index is out of range !");
+			}
+			return detail::pairwise_sum(line_data(index), columns_);
+		}
+
+		NUMBER column_sum(std::size_t column) const { // if column's index is out of range => returns NUMBER()
+			NUMBER result = NUMBER();
+			if (column < columns_) {
+				for (std::size_t line = 0; line < lines_; line++) {
+					result += line_data(line)[column];
+				}
+			}
+			return result;
+		}
+
+		NUMBER sum() const {
+			std::vector<NUMBER> partials(line_blocks());
+			math::parallel_for(partials.size(), [&](std::size_t block) {
+				const std::size_t first = block * lines_per_block();
+				const std::size_t last = std::min(lines_, first + lines_per_block());
+				std::vector<NUMBER> sums(last - first);
+				for (std::size_t line = first; line < last; line++) {
+					sums[line - first] = detail::pairwise_sum(line_data(line), columns_);
+				}
+				partials[block] = detail::pairwise_sum(sums.data(), sums.size());
+			});
+			detail::tree_combine(partials);
+			return partials.empty() ? NUMBER() : partials[0];
+		}
+
+		NUMBER mean() const { // NUMBER() for an empty matrix
+			if (lines_ == 0u || columns_ == 0u) {
+				return NUMBER();
+			}
+			return sum() / static_cast<NUMBER>(lines_ * columns_);
+		}
+
+		NUMBER min() const { // NUMBER() for an empty matrix
+			return extremum([](NUMBER const& a, NUMBER const& b) { return b < a; });
+		}
+
+		NUMBER max() const { // NUMBER() for an empty matrix
+			return extremum([](NUMBER const& a, NUMBER const& b) { return a < b; });
+		}
+
+		std::vector<NUMBER> line_sums() const {
+			std::vector<NUMBER> result(lines_);
+			math::parallel_for(line_blocks(), [&](std::size_t block) {
+				const std::size_t last = std::min(lines_, (block + 1u) * lines_per_block());
+				for (std::size_t line = block * lines_per_block(); line < last; line++) {
+					result[line] = detail::pairwise_sum(line_data(line), columns_);
+				}
+			});
+			return result;
+		}
+
+		std::vector<NUMBER> column_sums() const {
+			return aggregates().column_sums;
+		}
+
+		MatrixAggregates<NUMBER> aggregates() const {
+			/*
+			sum, min, max, mean, line sums and column sums in one pass over the values
+			every block of lines is read line by line : the column sums of a block are added to a vector
+			instead of going down each column
+			*/
+			MatrixAggregates<NUMBER> result;
+			result.line_sums.assign(lines_, NUMBER());
+			if (lines_ == 0u || columns_ == 0u) {
+				result.column_sums.assign(columns_, NUMBER());
+				return result;
+			}
+			const std::size_t blocks = line_blocks();
+			std::vector<NUMBER> sums(blocks);
+			std::vector<NUMBER> mins(blocks);
+			std::vector<NUMBER> maxs(blocks);
+			std::vector<std::vector<NUMBER>> columns(blocks);
+			math::parallel_for(blocks, [&](std::size_t block) {
+				const std::size_t first = block * lines_per_block();
+				const std::size_t last = std::min(lines_, first + lines_per_block());
+				std::vector<NUMBER>& column_sums = columns[block];
+				column_sums.assign(line_data(first), line_data(first) + columns_);
+				NUMBER low = line_data(first)[0];
+				NUMBER high = line_data(first)[0];
+				for (std::size_t line = first; line < last; line++) {
+					NUMBER const* values = line_data(line);
+					result.line_sums[line] = detail::pairwise_sum(values, columns_);
+					for (std::size_t column = 0; column < columns_; column++) {
+						if (line != first) {
+							column_sums[column] += values[column];
+						}
+						low = values[column] < low ? values[column] : low;
+						high = high < values[column] ? values[column] : high;
+					}
+				}
+				sums[block] = detail::pairwise_sum(result.line_sums.data() + first, last - first);
+				mins[block] = low;
+				maxs[block] = high;
+			});
+			detail::tree_combine(sums);
+			detail::tree_combine(columns);
+			result.sum = sums[0];
+			result.min = *std::min_element(mins.begin(), mins.end());
+			result.max = *std::max_element(maxs.begin(), maxs.end());
+			result.mean = result.sum / static_cast<NUMBER>(lines_ * columns_);
+			result.column_sums.swap(columns[0]);
+			return result;
+		}
+
+		void remove_line(std::size_t index) {
+			if (index >= lines_) {
+				error("math::Matrix2D::remove_line", "index of the line to remove is out of range !");
+			}
+			vals_.erase(vals_.begin() + index * stride_, vals_.begin() + (index + 1u) * stride_);
+			lines_--;
+		}
+
+		void remove_column(std::size_t index) { // if column is out of range, DOESN'T throw error => does nothing
+			if (index < columns_) {
+				for (std::size_t line = 0; line < lines_; line++) {
+					NUMBER* values = line_data(line);
+					std::copy(values + index + 1u, values + columns_, values + index);
+					values[columns_ - 1u] = NUMBER();
+				}
+				columns_--;
+			}
+		}
+
+		std::vector<std::vector<NUMBER>> vals() const {
+			std::vector<std::vector<NUMBER>> result;
+			result.reserve(lines_);
+			for (std::size_t line = 0; line < lines_; line++) {
+				result.push_back(std::vector<NUMBER>(line_data(line), line_data(line) + columns_));
+			}
+			return result;
+		}
+
+		void output_mode(matrix_mode mode) const {
+			output_ = mode;
+		}
+
+		matrix_mode output_mode() const {
+			return output_;
+		}
+
+		std::size_t max_val_size_line(std::size_t line) const {
+			// returns the max number of digits of a number in a line
+			if (line >= lines_) {
+				error("math::Matrix2D::max_val_size_line", "line index out of range");
+			}
+			std::size_t result = 0u;
+			for (std::size_t column = 0; column < columns_; column++) {
+				result = std::max(result, math::reduce_number(line_data(line)[column]).size());
+			}
+			return result;
+		}
+
+		std::size_t max_val_size_column(std::size_t column) const {
+			// returns the max number of digits of a number in a column => doesn't throw error, if out of range => does nothing
+			std::size_t result = 0u;
+			if (column < columns_) {
+				for (std::size_t line = 0; line < lines_; line++) {
+					result = std::max(result, std::to_string(line_data(line)[column]).size());
+				}
+			}
+			return result;
+		}
+
+	};
+
+	template<typename NUMBER, typename ALLOCATOR>
+	void multiply_add(Matrix2D<NUMBER, ALLOCATOR> const& a, Matrix2D<NUMBER, ALLOCATOR> const& b, Matrix2D<NUMBER, ALLOCATOR>& c, typename Matrix2D<NUMBER, ALLOCATOR>::number_type alpha = static_cast<NUMBER>(1), typename Matrix2D<NUMBER, ALLOCATOR>::number_type beta = NUMBER()) {
+		// c = alpha * a * b + beta * c, if beta is NUMBER() c is resized when needed
+		if (a.columns() != b.lines()) {
+			error("math::multiply_add", "a.columns() (" + std::to_string(a.columns()) + ") != b.lines() (" + std::to_string(b.lines()) + ")");
+		}
+		if (&c == &a || &c == &b) { // c can't be read and written at the same time
+			Matrix2D<NUMBER, ALLOCATOR> result = c;
+			math::multiply_add(a, b, result, alpha, beta);
+			c = result;
+			return;
+		}
+		if (c.lines() != a.lines() || c.columns() != b.columns()) {
+			if (beta != NUMBER()) {
+				error("math::multiply_add", "c is not a " + std::to_string(a.lines()) + "x" + std::to_string(b.columns()) + " matrix");
+			}
+			c = Matrix2D<NUMBER, ALLOCATOR>(a.lines(), b.columns(), c.get_allocator());
+		}
+		math::gemm(a.lines(), b.columns(), a.columns(), alpha, a.data(), a.stride(), b.data(), b.stride(), beta, c.data(), c.stride());
+	}
+
+	template<typename NUMBER, typename ALLOCATOR>
+	Matrix2D<NUMBER, ALLOCATOR> operator*(Matrix2D<NUMBER, ALLOCATOR> const& a, Matrix2D<NUMBER, ALLOCATOR> const& b) {
+		Matrix2D<NUMBER, ALLOCATOR> result(a.lines(), b.columns(), a.get_allocator());
+		math::multiply_add(a, b, result);
+		return result;
+	}
+
+	template<typename L, typename R>
+	Matrix2D<typename L::number_type> operator*(MatrixExpression<L> const& a, MatrixExpression<R> const& b) {
+		// expressions are evaluated first, the product can't be fused
+		return Matrix2D<typename L::number_type>(a) * Matrix2D<typename R::number_type>(b);
+	}
+
+	typedef math::Matrix2D<int> IMatrix2D;
+	typedef math::Matrix2D<float> FMatrix2D;
+	typedef math::Matrix2D<long long int> LIMatrix2D;
+	typedef math::Matrix2D<long double> LFMatrix2D;
+
+	namespace pmr {
+		template<typename NUMBER>
+		using Matrix2D = math::Matrix2D<NUMBER, std::pmr::polymorphic_allocator<NUMBER>>;
+	}
+}
+
+
+
+namespace math {
+
+	inline std::string_view matrix_separator(matrix_mode mode) {
+		switch (mode) {
+		case matrix_mode::GRID:
+			return "|";
+		case matrix_mode::SPACE:
+			return " ";
+		default:
+			return " | ";
+		}
+	}
+
+	template<typename NUMBER, typename ALLOCATOR>
+	void write_matrix(std::ostream& stream, Matrix2D<NUMBER, ALLOCATOR> const& matrix, matrix_mode mode) {
+		/*
+		every value is written with math::format_number (same text as math::reduce_number) followed by spaces up to the width of its column
+		1st pass : blocks of lines are formatted in parallel, each block keeps its text and the width of its columns
+		2nd pass : the texts are padded and written to the stream by big chunks
+		*/
+		constexpr std::size_t chunk = 1u << 16;
+		const std::string_view separator = math::matrix_separator(mode);
+		const std::size_t lines = matrix.lines();
+		const std::size_t columns = matrix.columns();
+		const std::size_t lines_per_block = std::max<std::size_t>(1u, detail::reduction_block / std::max<std::size_t>(1u, columns));
+		const std::size_t blocks = (lines + lines_per_block - 1u) / lines_per_block;
+		std::vector<std::vector<char>> texts(blocks);
+		std::vector<std::vector<std::uint16_t>> sizes(blocks); // max_number_size fits in 16 bits
+		std::vector<std::vector<std::size_t>> widths(blocks, std::vector<std::size_t>(columns, 0u));
+		math::parallel_for(blocks, [&](std::size_t block) {
+			std::vector<char>& text = texts[block];
+			std::size_t used = 0u;
+			const std::size_t last = std::min(lines, (block + 1u) * lines_per_block);
+			sizes[block].reserve((last - block * lines_per_block) * columns);
+			for (std::size_t line = block * lines_per_block; line < last; line++) {
+				for (std::size_t column = 0; column < columns; column++) {
+					if (used + max_number_size > text.size()) {
+						text.resize(std::max(2u * text.size(), used + max_number_size));
+					}
+					const std::size_t size = math::format_number(matrix.value(line, column), text.data() + used);
+					used += size;
+					sizes[block].push_back(static_cast<std::uint16_t>(size));
+					widths[block][column] = std::max(widths[block][column], size);
+				}
+			}
+		});
+		for (std::size_t block = 1; block < blocks; block++) {
+			for (std::size_t column = 0; column < columns; column++) {
+				widths[0][column] = std::max(widths[0][column], widths[block][column]);
+			}
+		}
+		std::vector<char> buffer(chunk + max_number_size + separator.size() + 1u);
+		std::size_t used = 0u;
+		for (std::size_t block = 0; block < blocks; block++) {
+			char const* text = texts[block].data();
+			std::uint16_t const* size = sizes[block].data();
+			const std::size_t last = std::min(lines, (block + 1u) * lines_per_block);
+			for (std::size_t line = block * lines_per_block; line < last; line++) {
+				for (std::size_t column = 0; column < columns; column++) {
+					if (used >= chunk) {
+						stream.write(buffer.data(), static_cast<std::streamsize>(used));
+						used = 0u;
+					}
+					std::memcpy(buffer.data() + used, text, *size);
+					std::memset(buffer.data() + used + *size, ' ', widths[0][column] - *size);
+					used += widths[0][column];
+					text += *size;
+					size++;
+					if (column != columns - 1u) {
+						std::memcpy(buffer.data() + used, separator.data(), separator.size());
+						used += separator.size();
+					}
+				}
+				if (line != lines - 1u) {
+					if (used >= chunk) { // no column => only the new lines fill the buffer
+						stream.write(buffer.data(), static_cast<std::streamsize>(used));
+						used = 0u;
+					}
+					buffer[used++] = '\n';
+				}
+			}
+		}
+		stream.write(buffer.data(), static_cast<std::streamsize>(used));
+	}
+
+	template<typename NUMBER, typename ALLOCATOR = std::allocator<NUMBER>>
+	Matrix2D<NUMBER, ALLOCATOR> parse_matrix(std::string_view text, ALLOCATOR const& allocator = ALLOCATOR()) {
+		/*
+		reads a matrix written by operator<< in any mode : one line per line of text,
+		values separated by spaces, tabs or '|', empty lines are ignored, short lines are filled by NUMBER()
+		*/
+		std::vector<NUMBER> values;
+		std::vector<std::size_t> sizes; // values per line
+		std::size_t columns = 0u;
+		char const* position = text.data();
+		char const* const last = text.data() + text.size();
+		while (position != last) {
+			char const* const end_of_line = std::find(position, last, '\n');
+			std::size_t size = 0u;
+			while (true) {
+				while (position != end_of_line && (*position == ' ' || *position == '|' || *position == '\t' || *position == '\r')) {
+					position++;
+				}
+				if (position == end_of_line) {
+					break;
+				}
+				NUMBER value = NUMBER();
+				char const* const next = math::parse_number(position, end_of_line, value);
+				if (next == position) {
+					error("math::parse_matrix", "invalid value at line " + std::to_string(sizes.size() + 1u) + " : " + std::string(position, std::find(position, end_of_line, ' ')));
+				}
+				values.push_back(value);
+				size++;
+				position = next;
+			}
+			if (size != 0u) {
+				sizes.push_back(size);
+				columns = std::max(columns, size);
+			}
+			position = end_of_line == last ? last : end_of_line + 1;
+		}
+		Matrix2D<NUMBER, ALLOCATOR> result(sizes.size(), columns, allocator);
+		NUMBER* target = result.data();
+		NUMBER const* source = values.data();
+		for (std::size_t line = 0; line < sizes.size(); line++) {
+			std::copy(source, source + sizes[line], target + line * result.stride());
+			source += sizes[line];
+		}
+		return result;
+	}
+}
+
+template<typename T>
+inline std::ostream& operator<<(std::ostream& stream, math::MatrixLine<T> const& line) { // same as std::vector
+	return stream << static_cast<std::vector<typename std::remove_const<T>::type>>(line);
+}
+
+template<typename NUMBER, typename ALLOCATOR>
+std::ostream& operator<<(std::ostream& stream, math::Matrix2D<NUMBER, ALLOCATOR> const& matrix) {
+	math::write_matrix(stream, matrix, matrix.output_mode());
+	return stream;
+}
+
+template<typename NUMBER, typename ALLOCATOR>
+std::istream& operator>>(std::istream& stream, math::Matrix2D<NUMBER, ALLOCATOR>& matrix) {
+	// reads the whole stream
+	const std::string text((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+	matrix = math::parse_matrix<NUMBER, ALLOCATOR>(text, matrix.get_allocator());
+	return stream;
+}
+
+#ifndef DISABLE_MATRIX_TYPES
+constexpr matrix_mode SPACE = matrix_mode::SPACE;
+constexpr matrix_mode GRID = matrix_mode::GRID;
+constexpr matrix_mode GRID_SPACE = matrix_mode::GRID_SPACE;
 #endif
\ No newline at end of file
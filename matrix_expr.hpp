@@ -0,0 +1,176 @@
+#pragma once
+
+#include "include.hpp"
+
+/*
+elementwise arithmetic on math::Matrix2D builds expression nodes instead of matrices :
+	math::FMatrix2D r = a * 2.f + b - c;
+builds Sub<Add<Scale<Matrix2D>, Matrix2D>, Matrix2D> and r is filled in a single pass, without any temporary matrix
+every node has lines(), columns() and value(line, column), leaves (Matrix2D) are kept by reference, nodes by copy
+=> an expression must be evaluated before the matrices it uses are destroyed (don't store it in auto)
+*/
+
+namespace math {
+
+	template<typename NUMBER, typename ALLOCATOR = std::allocator<NUMBER>>
+	class Matrix2D;
+
+	template<typename E>
+	class MatrixExpression {
+	public:
+		inline E const& self() const {
+			return static_cast<E const&>(*this);
+		}
+	};
+
+	template<typename E>
+	struct matrix_expression_storage { // nodes are small => copied
+		typedef E const type;
+	};
+
+	template<typename NUMBER, typename ALLOCATOR>
+	struct matrix_expression_storage<Matrix2D<NUMBER, ALLOCATOR>> { // matrices are big => referenced
+		typedef Matrix2D<NUMBER, ALLOCATOR> const& type;
+	};
+
+	template<typename L, typename R, typename OPERATION>
+	class MatrixBinaryExpression : public MatrixExpression<MatrixBinaryExpression<L, R, OPERATION>> {
+		typename matrix_expression_storage<L>::type left_;
+		typename matrix_expression_storage<R>::type right_;
+
+	public:
+		typedef typename L::number_type number_type;
+
+		MatrixBinaryExpression(L const& left, R const& right) : left_(left), right_(right) {
+			if (left.lines() != right.lines() || left.columns() != right.columns()) {
+				error("math::MatrixBinaryExpression", "matrices of different sizes (" + std::to_string(left.lines()) + "x" + std::to_string(left.columns()) + " and " + std::to_string(right.lines()) + "x" + std::to_string(right.columns()) + ")");
+			}
+		}
+
+		inline std::size_t lines() const {
+			return left_.lines();
+		}
+
+		inline std::size_t columns() const {
+			return left_.columns();
+		}
+
+		inline number_type value(std::size_t line, std::size_t column) const {
+			return OPERATION::apply(left_.value(line, column), right_.value(line, column));
+		}
+	};
+
+	template<typename E, typename FUNCTION>
+	class MatrixUnaryExpression : public MatrixExpression<MatrixUnaryExpression<E, FUNCTION>> {
+		typename matrix_expression_storage<E>::type expr_;
+		FUNCTION function_;
+
+	public:
+		typedef typename std::decay<decltype(std::declval<FUNCTION const&>()(std::declval<typename E::number_type>()))>::type number_type;
+
+		MatrixUnaryExpression(E const& expr, FUNCTION function) : expr_(expr), function_(function) {}
+
+		inline std::size_t lines() const {
+			return expr_.lines();
+		}
+
+		inline std::size_t columns() const {
+			return expr_.columns();
+		}
+
+		inline number_type value(std::size_t line, std::size_t column) const {
+			return function_(expr_.value(line, column));
+		}
+	};
+
+	namespace detail {
+
+		struct expression_add {
+			template<typename T>
+			static inline T apply(T const& a, T const& b) {
+				return a + b;
+			}
+		};
+
+		struct expression_sub {
+			template<typename T>
+			static inline T apply(T const& a, T const& b) {
+				return a - b;
+			}
+		};
+
+		struct expression_mul {
+			template<typename T>
+			static inline T apply(T const& a, T const& b) {
+				return a * b;
+			}
+		};
+
+		template<typename NUMBER>
+		struct expression_scale {
+			NUMBER factor;
+
+			inline NUMBER operator()(NUMBER const& value) const {
+				return value * factor;
+			}
+		};
+
+		template<typename NUMBER>
+		struct expression_divide {
+			NUMBER divisor;
+
+			inline NUMBER operator()(NUMBER const& value) const {
+				return value / divisor;
+			}
+		};
+
+		template<typename NUMBER>
+		struct expression_negate {
+			inline NUMBER operator()(NUMBER const& value) const {
+				return -value;
+			}
+		};
+	}
+
+	template<typename L, typename R>
+	inline MatrixBinaryExpression<L, R, detail::expression_add> operator+(MatrixExpression<L> const& left, MatrixExpression<R> const& right) {
+		return MatrixBinaryExpression<L, R, detail::expression_add>(left.self(), right.self());
+	}
+
+	template<typename L, typename R>
+	inline MatrixBinaryExpression<L, R, detail::expression_sub> operator-(MatrixExpression<L> const& left, MatrixExpression<R> const& right) {
+		return MatrixBinaryExpression<L, R, detail::expression_sub>(left.self(), right.self());
+	}
+
+	template<typename L, typename R>
+	inline MatrixBinaryExpression<L, R, detail::expression_mul> hadamard(MatrixExpression<L> const& left, MatrixExpression<R> const& right) {
+		// elementwise product, operator* between two matrices is the matrix product
+		return MatrixBinaryExpression<L, R, detail::expression_mul>(left.self(), right.self());
+	}
+
+	template<typename E>
+	inline MatrixUnaryExpression<E, detail::expression_scale<typename E::number_type>> operator*(MatrixExpression<E> const& expr, typename E::number_type factor) {
+		return MatrixUnaryExpression<E, detail::expression_scale<typename E::number_type>>(expr.self(), { factor });
+	}
+
+	template<typename E>
+	inline MatrixUnaryExpression<E, detail::expression_scale<typename E::number_type>> operator*(typename E::number_type factor, MatrixExpression<E> const& expr) {
+		return MatrixUnaryExpression<E, detail::expression_scale<typename E::number_type>>(expr.self(), { factor });
+	}
+
+	template<typename E>
+	inline MatrixUnaryExpression<E, detail::expression_divide<typename E::number_type>> operator/(MatrixExpression<E> const& expr, typename E::number_type divisor) {
+		return MatrixUnaryExpression<E, detail::expression_divide<typename E::number_type>>(expr.self(), { divisor });
+	}
+
+	template<typename E>
+	inline MatrixUnaryExpression<E, detail::expression_negate<typename E::number_type>> operator-(MatrixExpression<E> const& expr) {
+		return MatrixUnaryExpression<E, detail::expression_negate<typename E::number_type>>(expr.self(), {});
+	}
+
+	template<typename E, typename FUNCTION>
+	inline MatrixUnaryExpression<E, FUNCTION> apply(MatrixExpression<E> const& expr, FUNCTION function) {
+		// ex : math::apply(a - b, [](float x) { return std::abs(x); })
+		return MatrixUnaryExpression<E, FUNCTION>(expr.self(), function);
+	}
+}
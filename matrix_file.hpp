@@ -0,0 +1,276 @@
+#pragma once
+
+#include "include.hpp"
+#include "matrix.hpp"
+#include "mapped_file.hpp"
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+enum class matrix_dtype : std::uint32_t { INT32 = 1, INT64 = 2, FLOAT32 = 3, FLOAT64 = 4, LONG_DOUBLE = 5 };
+
+/*
+binary matrix file :
+	MatrixFileHeader (64 bytes)
+	padding up to data_offset (multiple of alignment)
+	lines * columns values, line after line, in the byte order of the machine that wrote the file
+the values can be used in place => math::MappedMatrix opens a file of any size without reading it
+checksum is a FNV-1a over 4 interleaved 64-bit lanes (math::matrix_checksum), 0 if the file was saved without
+*/
+
+namespace math {
+
+	struct MatrixFileHeader {
+		char magic[8] = { 'M', 'L', 'M', 'A', 'T', 'R', 'I', 'X' };
+		std::uint32_t version = 1u;
+		std::uint32_t byte_order = 0x01020304u; // read back as 0x04030201 on a machine with the other endianness
+		std::uint32_t dtype = 0u;
+		std::uint32_t value_size = 0u; // sizeof(NUMBER), long double isn't the same everywhere
+		std::uint64_t lines = 0u;
+		std::uint64_t columns = 0u;
+		std::uint64_t alignment = 64u;
+		std::uint64_t data_offset = 64u;
+		std::uint64_t checksum = 0u;
+	};
+	static_assert(sizeof(MatrixFileHeader) == 64u, "math::MatrixFileHeader must be 64 bytes");
+
+	template<typename NUMBER>
+	struct matrix_file_type; // only the types below can be saved
+
+	template<>
+	struct matrix_file_type<int> {
+		static constexpr matrix_dtype dtype = matrix_dtype::INT32;
+	};
+
+	template<>
+	struct matrix_file_type<long long int> {
+		static constexpr matrix_dtype dtype = matrix_dtype::INT64;
+	};
+
+	template<>
+	struct matrix_file_type<float> {
+		static constexpr matrix_dtype dtype = matrix_dtype::FLOAT32;
+	};
+
+	template<>
+	struct matrix_file_type<double> {
+		static constexpr matrix_dtype dtype = matrix_dtype::FLOAT64;
+	};
+
+	template<>
+	struct matrix_file_type<long double> {
+		static constexpr matrix_dtype dtype = matrix_dtype::LONG_DOUBLE;
+	};
+
+	class MatrixChecksum {
+		// FNV-1a on 64-bit words, 4 independent lanes so the multiplications don't wait for each other
+		std::uint64_t lanes_[4] = { 0xcbf29ce484222325ull, 0x84222325cbf29ce4ull, 0xcbf29ce484222325ull ^ 1u, 0x84222325cbf29ce4ull ^ 1u };
+		unsigned char pending_[32] = {};
+		std::size_t pending_size_ = 0u;
+		std::uint64_t total_ = 0u;
+
+		static constexpr std::uint64_t prime = 0x100000001b3ull;
+
+		inline void block(unsigned char const* bytes) {
+			for (std::size_t lane = 0; lane < 4u; lane++) {
+				std::uint64_t word;
+				std::memcpy(&word, bytes + lane * 8u, 8u);
+				lanes_[lane] = (lanes_[lane] ^ word) * prime;
+			}
+		}
+
+	public:
+		void update(void const* data, std::size_t size) {
+			unsigned char const* bytes = static_cast<unsigned char const*>(data);
+			total_ += size;
+			if (pending_size_ != 0u) {
+				const std::size_t count = std::min(size, 32u - pending_size_);
+				std::memcpy(pending_ + pending_size_, bytes, count);
+				pending_size_ += count;
+				bytes += count;
+				size -= count;
+				if (pending_size_ < 32u) {
+					return;
+				}
+				block(pending_);
+				pending_size_ = 0u;
+			}
+			for (; size >= 32u; bytes += 32u, size -= 32u) {
+				block(bytes);
+			}
+			std::memcpy(pending_, bytes, size);
+			pending_size_ = size;
+		}
+
+		std::uint64_t result() const {
+			std::uint64_t hash = 0xcbf29ce484222325ull;
+			for (std::size_t i = 0; i < pending_size_; i++) {
+				hash = (hash ^ pending_[i]) * prime;
+			}
+			for (std::uint64_t lane : lanes_) {
+				hash = (hash ^ lane) * prime;
+			}
+			hash = (hash ^ total_) * prime;
+			return hash == 0u ? 1u : hash; // 0 means "no checksum"
+		}
+	};
+
+	inline std::uint64_t matrix_checksum(void const* data, std::size_t size) {
+		MatrixChecksum checksum;
+		checksum.update(data, size);
+		return checksum.result();
+	}
+
+	template<typename NUMBER>
+	MatrixFileHeader read_matrix_header(char const* data, std::size_t size, std::string const& path) {
+		// checks everything that can be checked without reading the values
+		MatrixFileHeader header;
+		if (size < sizeof(MatrixFileHeader)) {
+			error("math::read_matrix_header", path + " is too small to be a matrix file");
+		}
+		std::memcpy(&header, data, sizeof(MatrixFileHeader));
+		if (std::memcmp(header.magic, MatrixFileHeader().magic, 8u) != 0) {
+			error("math::read_matrix_header", path + " is not a matrix file");
+		}
+		if (header.version != 1u) {
+			error("math::read_matrix_header", path + " : unknown version " + std::to_string(header.version));
+		}
+		if (header.byte_order != MatrixFileHeader().byte_order) {
+			error("math::read_matrix_header", path + " was written with another byte order");
+		}
+		if (header.dtype != static_cast<std::uint32_t>(matrix_file_type<NUMBER>::dtype) || header.value_size != sizeof(NUMBER)) {
+			error("math::read_matrix_header", path + " doesn't hold values of the requested type");
+		}
+		if (header.data_offset < sizeof(MatrixFileHeader) || header.data_offset > size || (size - header.data_offset) / sizeof(NUMBER) / std::max<std::uint64_t>(1u, header.columns) < header.lines) {
+			error("math::read_matrix_header", path + " is truncated");
+		}
+		if (header.data_offset % alignof(NUMBER) != 0u) { // the values are used in place
+			error("math::read_matrix_header", path + " : data_offset isn't aligned for the values");
+		}
+		return header;
+	}
+
+	template<typename NUMBER>
+	void save(Matrix2D<NUMBER> const& matrix, std::string const& path, bool checksum = true, std::size_t alignment = 64u) {
+		// alignment : the values start at a multiple of alignment bytes (power of 2, >= 64)
+		if (alignment < 64u || (alignment & (alignment - 1u)) != 0u) {
+			error("math::save", "alignment must be a power of 2 >= 64");
+		}
+		MatrixFileHeader header;
+		header.dtype = static_cast<std::uint32_t>(matrix_file_type<NUMBER>::dtype);
+		header.value_size = sizeof(NUMBER);
+		header.lines = matrix.lines();
+		header.columns = matrix.columns();
+		header.alignment = alignment;
+		header.data_offset = (sizeof(MatrixFileHeader) + alignment - 1u) / alignment * alignment;
+		const std::size_t line_size = matrix.columns() * sizeof(NUMBER);
+		const bool contiguous = matrix.stride() == matrix.columns();
+		if (checksum) {
+			MatrixChecksum sum;
+			if (contiguous) {
+				sum.update(matrix.data(), line_size * matrix.lines());
+			}
+			else {
+				for (std::size_t line = 0; line < matrix.lines(); line++) {
+					sum.update(matrix.data() + line * matrix.stride(), line_size);
+				}
+			}
+			header.checksum = sum.result();
+		}
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		if (!file) {
+			error("math::save", "can't open " + path);
+		}
+		file.write(reinterpret_cast<char const*>(&header), sizeof(MatrixFileHeader));
+		const std::vector<char> padding(header.data_offset - sizeof(MatrixFileHeader), '\0');
+		file.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+		if (contiguous) { // one write for the whole matrix
+			file.write(reinterpret_cast<char const*>(matrix.data()), static_cast<std::streamsize>(line_size * matrix.lines()));
+		}
+		else {
+			for (std::size_t line = 0; line < matrix.lines(); line++) {
+				file.write(reinterpret_cast<char const*>(matrix.data() + line * matrix.stride()), static_cast<std::streamsize>(line_size));
+			}
+		}
+		if (!file) {
+			error("math::save", "can't write " + path);
+		}
+	}
+
+	template<typename NUMBER>
+	Matrix2D<NUMBER> load(std::string const& path, bool check = true) {
+		// check : compares the checksum when the file has one
+		std::ifstream file(path, std::ios::binary | std::ios::ate);
+		if (!file) {
+			error("math::load", "can't open " + path);
+		}
+		const std::size_t size = static_cast<std::size_t>(file.tellg());
+		file.seekg(0);
+		char raw[sizeof(MatrixFileHeader)] = {};
+		file.read(raw, sizeof(MatrixFileHeader));
+		const MatrixFileHeader header = read_matrix_header<NUMBER>(raw, size, path);
+		Matrix2D<NUMBER> result(static_cast<std::size_t>(header.lines), static_cast<std::size_t>(header.columns)); // stride == columns
+		file.seekg(static_cast<std::streamoff>(header.data_offset));
+		const std::size_t data_size = static_cast<std::size_t>(header.lines * header.columns) * sizeof(NUMBER);
+		file.read(reinterpret_cast<char*>(result.data()), static_cast<std::streamsize>(data_size));
+		if (!file) {
+			error("math::load", "can't read " + path);
+		}
+		if (check && header.checksum != 0u && matrix_checksum(result.data(), data_size) != header.checksum) {
+			error("math::load", path + " is corrupted (wrong checksum)");
+		}
+		return result;
+	}
+
+	template<typename NUMBER>
+	class MappedMatrix {
+		// read-only matrix using the pages of a matrix file directly
+		MappedFile file_;
+		MatrixFileHeader header_;
+		NUMBER const* vals_ = nullptr;
+
+	public:
+		MappedMatrix(std::string const& path) : file_(path) {
+			header_ = read_matrix_header<NUMBER>(file_.data(), file_.size(), path);
+			vals_ = reinterpret_cast<NUMBER const*>(file_.data() + header_.data_offset);
+		}
+
+		inline std::size_t lines() const {
+			return static_cast<std::size_t>(header_.lines);
+		}
+
+		inline std::size_t columns() const {
+			return static_cast<std::size_t>(header_.columns);
+		}
+
+		inline NUMBER const* data() const {
+			return vals_;
+		}
+
+		inline NUMBER const& value(std::size_t line, std::size_t column) const { // no bounds checking
+			return vals_[line * columns() + column];
+		}
+
+		MatrixLine<const NUMBER> operator[](std::size_t index) const {
+			if (index >= lines()) {
+				error("math::MappedMatrix::operator[]", "index (" + std::to_string(index) + ") >= lines()");
+			}
+			return MatrixLine<const NUMBER>(vals_ + index * columns(), columns());
+		}
+
+		inline MatrixFileHeader const& header() const {
+			return header_;
+		}
+
+		bool verify() const {
+			// reads every value => not done when the file is opened
+			return header_.checksum == 0u || matrix_checksum(vals_, lines() * columns() * sizeof(NUMBER)) == header_.checksum;
+		}
+
+		Matrix2D<NUMBER> to_matrix2d() const {
+			Matrix2D<NUMBER> result(lines(), columns());
+			std::copy(vals_, vals_ + lines() * columns(), result.data());
+			return result;
+		}
+	};
+}
@@ -0,0 +1,198 @@
+#pragma once
+
+#include "include.hpp"
+#include <cstdint>
+#include <memory_resource>
+#include <mutex>
+
+/*
+memory resources for the buffers of the matrices, to be used with std::pmr::polymorphic_allocator (math::pmr::Matrix2D) :
+	math::MatrixArena arena;
+	math::pmr::Matrix2D<float> a(100, 100, &arena); // every buffer allocated during a request comes from arena
+	...
+	arena.release(); // everything is given back at once
+every block is aligned on at least math::matrix_alignment bytes (one cache line, enough for any SIMD load)
+*/
+
+namespace math {
+
+	constexpr std::size_t matrix_alignment = 64u;
+
+	namespace detail {
+
+		inline std::size_t align_up(std::size_t value, std::size_t alignment) { // alignment is a power of 2
+			return (value + alignment - 1u) & ~(alignment - 1u);
+		}
+	}
+
+	class MatrixArena : public std::pmr::memory_resource {
+		/*
+		monotonic : allocate() moves a pointer forward, deallocate() does nothing, release() frees every chunk
+		chunks are taken from upstream and double in size up to max_chunk => few upstream calls even for thousands of matrices
+		not synchronized, one arena per thread (or per request)
+		*/
+		struct Chunk {
+			Chunk* previous;
+			std::size_t size;
+		};
+
+		std::pmr::memory_resource* upstream_;
+		std::size_t initial_size_;
+		std::size_t next_size_;
+		Chunk* chunks_ = nullptr;
+		char* position_ = nullptr;
+		char* end_ = nullptr;
+
+		static constexpr std::size_t max_chunk = 1u << 24;
+		static constexpr std::size_t header_size = (sizeof(Chunk) + matrix_alignment - 1u) / matrix_alignment * matrix_alignment;
+
+	protected:
+		void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+			alignment = std::max(alignment, matrix_alignment);
+			std::size_t offset = detail::align_up(reinterpret_cast<std::uintptr_t>(position_), alignment) - reinterpret_cast<std::uintptr_t>(position_);
+			if (position_ == nullptr || static_cast<std::size_t>(end_ - position_) < offset + bytes) {
+				const std::size_t size = std::max(next_size_, detail::align_up(header_size + bytes + alignment, matrix_alignment));
+				Chunk* chunk = static_cast<Chunk*>(upstream_->allocate(size, matrix_alignment));
+				chunk->previous = chunks_;
+				chunk->size = size;
+				chunks_ = chunk;
+				position_ = reinterpret_cast<char*>(chunk) + header_size;
+				end_ = reinterpret_cast<char*>(chunk) + size;
+				next_size_ = std::min(std::max(next_size_, size) * 2u, std::max(max_chunk, next_size_));
+				offset = detail::align_up(reinterpret_cast<std::uintptr_t>(position_), alignment) - reinterpret_cast<std::uintptr_t>(position_);
+			}
+			void* result = position_ + offset;
+			position_ += offset + bytes;
+			return result;
+		}
+
+		void do_deallocate(void*, std::size_t, std::size_t) override {}
+
+		bool do_is_equal(std::pmr::memory_resource const& other) const noexcept override {
+			return this == &other;
+		}
+
+	public:
+		explicit MatrixArena(std::size_t initial_size = 1u << 16, std::pmr::memory_resource* upstream = std::pmr::new_delete_resource()) : upstream_(upstream), initial_size_(std::max<std::size_t>(initial_size, 1024u)), next_size_(initial_size_) {}
+
+		MatrixArena(MatrixArena const&) = delete;
+		MatrixArena& operator=(MatrixArena const&) = delete;
+
+		~MatrixArena() {
+			release();
+		}
+
+		void release() {
+			// every matrix using the arena must be destroyed (or never used again) before
+			while (chunks_ != nullptr) {
+				Chunk* previous = chunks_->previous;
+				upstream_->deallocate(chunks_, chunks_->size, matrix_alignment);
+				chunks_ = previous;
+			}
+			position_ = nullptr;
+			end_ = nullptr;
+			next_size_ = initial_size_;
+		}
+
+		inline std::pmr::memory_resource* upstream() const {
+			return upstream_;
+		}
+	};
+
+	class MatrixPool : public std::pmr::memory_resource {
+		/*
+		size classes : powers of 2 from matrix_alignment to max_block bytes, a released block goes to the free list of its class
+		and is given back by the next allocation of the same class => a loop creating and destroying matrices of the same sizes
+		stops calling upstream after its first iteration
+		bigger blocks go directly to upstream
+		synchronized, can be shared between threads
+		*/
+		static constexpr std::size_t classes = 32u;
+
+		struct FreeBlock {
+			FreeBlock* next;
+		};
+
+		std::pmr::memory_resource* upstream_;
+		std::size_t max_block_;
+		FreeBlock* free_[classes] = {};
+		std::vector<std::pair<void*, std::size_t>> owned_; // every block taken from upstream, for release()
+		std::mutex mutex_;
+
+		static inline std::size_t size_class(std::size_t bytes, std::size_t& size) {
+			std::size_t index = 0u;
+			size = matrix_alignment;
+			while (size < bytes) {
+				size *= 2u;
+				index++;
+			}
+			return index;
+		}
+
+	protected:
+		void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+			alignment = std::max(alignment, matrix_alignment);
+			if (bytes > max_block_ || alignment > matrix_alignment) {
+				return upstream_->allocate(bytes, alignment);
+			}
+			std::size_t size = 0u;
+			const std::size_t index = size_class(bytes, size);
+			std::lock_guard<std::mutex> lock(mutex_);
+			if (free_[index] != nullptr) {
+				FreeBlock* block = free_[index];
+				free_[index] = block->next;
+				return block;
+			}
+			void* block = upstream_->allocate(size, matrix_alignment);
+			owned_.emplace_back(block, size);
+			return block;
+		}
+
+		void do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment) override {
+			alignment = std::max(alignment, matrix_alignment);
+			if (bytes > max_block_ || alignment > matrix_alignment) {
+				upstream_->deallocate(pointer, bytes, alignment);
+				return;
+			}
+			std::size_t size = 0u;
+			const std::size_t index = size_class(bytes, size);
+			std::lock_guard<std::mutex> lock(mutex_);
+			FreeBlock* block = static_cast<FreeBlock*>(pointer);
+			block->next = free_[index];
+			free_[index] = block;
+		}
+
+		bool do_is_equal(std::pmr::memory_resource const& other) const noexcept override {
+			return this == &other;
+		}
+
+	public:
+		explicit MatrixPool(std::size_t max_block = 1u << 22, std::pmr::memory_resource* upstream = std::pmr::new_delete_resource()) : upstream_(upstream), max_block_(max_block) {
+			std::size_t size = 0u;
+			if (size_class(max_block_, size) >= classes) {
+				error("math::MatrixPool::MatrixPool", "max_block is too big");
+			}
+		}
+
+		MatrixPool(MatrixPool const&) = delete;
+		MatrixPool& operator=(MatrixPool const&) = delete;
+
+		~MatrixPool() {
+			release();
+		}
+
+		void release() {
+			// gives every pooled block back to upstream, the matrices using them must be destroyed before
+			std::lock_guard<std::mutex> lock(mutex_);
+			for (std::pair<void*, std::size_t> const& block : owned_) {
+				upstream_->deallocate(block.first, block.second, matrix_alignment);
+			}
+			owned_.clear();
+			std::fill(std::begin(free_), std::end(free_), nullptr);
+		}
+
+		inline std::pmr::memory_resource* upstream() const {
+			return upstream_;
+		}
+	};
+}
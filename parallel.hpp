@@ -0,0 +1,64 @@
+#pragma once
+
+#include "include.hpp"
+#include <atomic>
+#include <thread>
+
+/*
+minimal thread helpers shared by the heavy algorithms of the library
+the number of threads defaults to std::thread::hardware_concurrency(), math::thread_count(n) changes it
+define DISABLE_THREADS to run everything on the calling thread
+*/
+
+namespace math {
+
+	namespace detail {
+		inline std::atomic<std::size_t>& thread_count_setting() {
+			static std::atomic<std::size_t> setting(0u); // 0 => hardware_concurrency
+			return setting;
+		}
+	}
+
+	inline std::size_t thread_count() {
+#ifdef DISABLE_THREADS
+		return 1u;
+#else
+		const std::size_t setting = detail::thread_count_setting().load();
+		if (setting != 0u) {
+			return setting;
+		}
+		return std::max(1u, std::thread::hardware_concurrency());
+#endif
+	}
+
+	inline void thread_count(std::size_t count) { // 0 => back to hardware_concurrency
+		detail::thread_count_setting().store(count);
+	}
+
+	template<typename FUNCTION>
+	void parallel_for(std::size_t count, FUNCTION const& function) {
+		// calls function(i) for every i in [0, count), the tasks are shared between the threads in any order
+		const std::size_t threads = std::min(math::thread_count(), count);
+		if (threads <= 1u) {
+			for (std::size_t i = 0; i < count; i++) {
+				function(i);
+			}
+			return;
+		}
+		std::atomic<std::size_t> next(0u);
+		auto work = [&]() {
+			for (std::size_t i = next.fetch_add(1u); i < count; i = next.fetch_add(1u)) {
+				function(i);
+			}
+		};
+		std::vector<std::thread> workers;
+		workers.reserve(threads - 1u);
+		for (std::size_t i = 1; i < threads; i++) {
+			workers.emplace_back(work);
+		}
+		work();
+		for (std::thread& worker : workers) {
+			worker.join();
+		}
+	}
+}
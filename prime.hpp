@@ -1,69 +1,903 @@
-#pragma once
-
-#include "include.hpp"
-
-namespace math {
-	inline bool is_prime(long long int number) {
-		if (number < 0) {
-			return math::is_prime(std::abs(number));
-		}
-		if (number == 0 || number == 1) {
-			return false;
-		}
-		if (number == 2) {
-			return true;
-		}
-		if (number % 2 == 0) {
-			return false;
-		}
-		const long long int limit = static_cast<long long int>(std::sqrt(number) + 1);
-		for (std::size_t i = 3; i < limit; i += 2) {
-			if (number % i == 0) {
-				return false;
-			}
-		}
-		return true;
-	}
-
-	inline long long int first_divisor(long long int number) {
-		if (number < 0) {
-			return 0 - math::first_divisor(std::abs(number));
-		}
-		if (math::is_prime(number)) {
-			return number;
-		}
-		const long long int limit = static_cast<long long int>(std::sqrt(number) + 1);
-		for (std::size_t i = 3; i < limit; i += 2) {
-			if (number % i == 0) {
-				return i;
-			}
-		}
-	}
-
-	inline std::vector<long long int> prime_factors(long long int number) {
-		if (number < 0) {
-			std::vector<long long int> result = math::prime_factors(std::abs(number));
-			for (long long int& val : result) {
-				val -= val * 2; // 4 => -4
-			}
-			return result;
-		}
-		std::vector<long long int> factors;
-		factors.reserve(static_cast<std::size_t>(number)); // in the case of lot of divisors
-		while (number % 2 == 0) {
-			factors.push_back(2ll);
-			number /= 2;
-		}
-		const std::size_t limit = static_cast<std::size_t>(std::sqrt(number) + 1);
-		for (std::size_t i = 3; i < limit; i += 2) {
-			while (number % i == 0) {
-				factors.push_back(i);
-				number /= i;
-			}
-		}
-		if (number > 2) {
-			factors.push_back(number);
-		}
-		return factors;
-	}
-}
\ No newline at end of file
+#pragma once
+
+#include "include.hpp"
+#include "parallel.hpp"
+#include "mapped_file.hpp"
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+/*
+math::is_prime is deterministic on every 64-bit integer :
+	n < detail::small_prime_limit : one bit of a table computed at compile time
+	otherwise : trial division by the first primes, then Miller-Rabin with 7 fixed bases (enough below 2^64),
+	the modular products in Montgomery form (no division) => a few microseconds for any n
+math::prime_factors / math::prime_factorization : trial division below 2^10, then Miller-Rabin and Pollard-Brent rho
+	=> milliseconds for any 64-bit number
+	below the bound of the shared math::FactorTable (math::factor_table(bound) builds it) they only read the table
+math::primes(lo, hi) and math::count_primes(lo, hi) run a segmented sieve of Eratosthenes on a mod 30 wheel (see detail::WheelSieve)
+math::prime_pi(x) counts the primes <= x in O(x^(3/4)) without sieving up to x
+*/
+
+namespace math {
+
+	namespace detail {
+
+		constexpr std::uint64_t small_prime_limit = 1u << 16;
+
+		struct SmallPrimes {
+			std::uint64_t bits[small_prime_limit / 128u] = {}; // odd numbers only : bit n / 2 is set if n is prime
+
+			constexpr SmallPrimes() {
+				for (std::uint64_t& word : bits) {
+					word = ~0ull;
+				}
+				bits[0] &= ~1ull; // 1
+				for (std::uint64_t i = 3; i * i < small_prime_limit; i += 2) {
+					if (test(i)) {
+						for (std::uint64_t j = i * i; j < small_prime_limit; j += 2 * i) {
+							bits[j >> 7] &= ~(1ull << ((j >> 1) & 63u));
+						}
+					}
+				}
+			}
+
+			constexpr bool test(std::uint64_t odd) const { // odd < small_prime_limit
+				return ((bits[odd >> 7] >> ((odd >> 1) & 63u)) & 1u) != 0u;
+			}
+		};
+
+		inline constexpr SmallPrimes small_primes{};
+
+		class Montgomery {
+			/*
+			arithmetic modulo an odd n on values in Montgomery form (a * 2^64 mod n) :
+			a product is reduced with 2 multiplications and a subtraction instead of a 128-bit division
+			*/
+			std::uint64_t n_;
+			std::uint64_t inverse_ = 0u; // n * inverse_ == 1 mod 2^64
+			std::uint64_t r2_ = 0u; // 2^128 mod n
+
+		public:
+			explicit Montgomery(std::uint64_t n) : n_(n) {
+#ifdef __SIZEOF_INT128__
+				inverse_ = n; // right on 3 bits for an odd n, each Newton step doubles it
+				for (int i = 0; i < 5; i++) {
+					inverse_ *= 2u - n * inverse_;
+				}
+				const unsigned __int128 r = (0ull - n) % n; // 2^64 mod n
+				r2_ = static_cast<std::uint64_t>(r * r % n);
+#endif
+			}
+
+			inline std::uint64_t modulus() const {
+				return n_;
+			}
+
+			inline std::uint64_t multiply(std::uint64_t a, std::uint64_t b) const {
+#ifdef __SIZEOF_INT128__
+				const unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+				// product - m * n is a multiple of 2^64 => only the high halves are needed
+				const std::uint64_t m = static_cast<std::uint64_t>(product) * inverse_;
+				const std::uint64_t high = static_cast<std::uint64_t>(product >> 64);
+				const std::uint64_t correction = static_cast<std::uint64_t>((static_cast<unsigned __int128>(m) * n_) >> 64);
+				return high >= correction ? high - correction : high - correction + n_;
+#else
+				// no 128-bit integer : plain a * b mod n by doubling (the Montgomery form is the value itself)
+				std::uint64_t result = 0u;
+				a %= n_;
+				for (; b != 0u; b >>= 1) {
+					if ((b & 1u) != 0u) {
+						result = result >= n_ - a ? result - (n_ - a) : result + a;
+					}
+					a = a >= n_ - a ? a - (n_ - a) : a + a;
+				}
+				return result;
+#endif
+			}
+
+			inline std::uint64_t to(std::uint64_t value) const { // value < n
+#ifdef __SIZEOF_INT128__
+				return multiply(value, r2_);
+#else
+				return value;
+#endif
+			}
+
+			inline std::uint64_t power(std::uint64_t base, std::uint64_t exponent) const { // base in Montgomery form
+				std::uint64_t result = to(1u);
+				for (; exponent != 0u; exponent >>= 1) {
+					if ((exponent & 1u) != 0u) {
+						result = multiply(result, base);
+					}
+					base = multiply(base, base);
+				}
+				return result;
+			}
+		};
+
+		inline bool miller_rabin(std::uint64_t n) {
+			// n odd and > 2, exact for every n < 2^64 with these bases (Jim Sinclair)
+			constexpr std::uint64_t bases[] = { 2u, 325u, 9375u, 28178u, 450775u, 9780504u, 1795265022u };
+			const Montgomery field(n);
+			std::uint64_t odd = n - 1u;
+			int twos = 0;
+			while ((odd & 1u) == 0u) {
+				odd >>= 1;
+				twos++;
+			}
+			const std::uint64_t one = field.to(1u);
+			const std::uint64_t minus_one = field.to(n - 1u);
+			for (std::uint64_t base : bases) {
+				const std::uint64_t a = base % n;
+				if (a == 0u) {
+					continue;
+				}
+				std::uint64_t x = field.power(field.to(a), odd);
+				if (x == one || x == minus_one) {
+					continue;
+				}
+				bool composite = true;
+				for (int i = 1; i < twos && composite; i++) {
+					x = field.multiply(x, x);
+					composite = x != minus_one;
+				}
+				if (composite) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		inline bool is_prime(std::uint64_t n) {
+			if (n < small_prime_limit) {
+				return n == 2u || ((n & 1u) != 0u && small_primes.test(n));
+			}
+			if ((n & 1u) == 0u) {
+				return false;
+			}
+			for (std::uint64_t p : { 3u, 5u, 7u, 11u, 13u, 17u, 19u, 23u, 29u, 31u, 37u, 41u, 43u, 47u }) { // rejects most composites before Miller-Rabin
+				if (n % p == 0u) {
+					return false;
+				}
+			}
+			return detail::miller_rabin(n);
+		}
+	}
+
+	inline bool is_prime(long long int number) {
+		const std::uint64_t n = static_cast<std::uint64_t>(number);
+		return detail::is_prime(number < 0 ? 0u - n : n);
+	}
+
+	inline void is_prime(long long int const* numbers, std::size_t size, bool* primes) {
+		// primes[i] = is_prime(numbers[i]), blocks of numbers are shared between the threads
+		constexpr std::size_t block = 1u << 10;
+		math::parallel_for((size + block - 1u) / block, [&](std::size_t index) {
+			const std::size_t last = std::min(size, (index + 1u) * block);
+			for (std::size_t i = index * block; i < last; i++) {
+				primes[i] = math::is_prime(numbers[i]);
+			}
+		});
+	}
+
+	inline std::vector<bool> is_prime(std::vector<long long int> const& numbers) {
+		const std::unique_ptr<bool[]> primes(new bool[numbers.size()]);
+		math::is_prime(numbers.data(), numbers.size(), primes.get());
+		return std::vector<bool>(primes.get(), primes.get() + numbers.size());
+	}
+
+	namespace detail {
+
+		/*
+		wheel sieve : a byte holds the 30 numbers [30 i, 30 i + 30), one bit per residue coprime to 30
+		=> 2, 3 and 5 are never stored and 1 bit covers 3.75 numbers
+		a segment is sieve_segment_bytes long to stay in the L1 cache, only the primes up to sqrt(hi) are kept
+		*/
+		constexpr std::size_t sieve_segment_bytes = 1u << 15;
+		constexpr std::uint64_t sieve_segment_span = 30u * sieve_segment_bytes;
+		constexpr unsigned char wheel_residues[8] = { 1u, 7u, 11u, 13u, 17u, 19u, 23u, 29u };
+		constexpr unsigned char wheel_bits[30] = { // residue => bit, 8 if not coprime to 30
+			8u, 0u, 8u, 8u, 8u, 8u, 8u, 1u, 8u, 8u, 8u, 2u, 8u, 3u, 8u, 8u, 8u, 4u, 8u, 5u, 8u, 8u, 8u, 6u, 8u, 8u, 8u, 8u, 8u, 7u
+		};
+
+		inline int lowest_bit(unsigned int value) { // value != 0
+#if defined(__GNUC__)
+			return __builtin_ctz(value);
+#else
+			int result = 0;
+			for (; (value & 1u) == 0u; value >>= 1) {
+				result++;
+			}
+			return result;
+#endif
+		}
+
+		inline std::size_t bit_count(std::uint64_t value) {
+#if defined(__GNUC__)
+			return static_cast<std::size_t>(__builtin_popcountll(value));
+#else
+			std::size_t result = 0;
+			for (; value != 0u; value &= value - 1u) {
+				result++;
+			}
+			return result;
+#endif
+		}
+
+		inline std::uint64_t integer_sqrt(std::uint64_t value) {
+			std::uint64_t result = static_cast<std::uint64_t>(std::sqrt(static_cast<long double>(value)));
+			while (result > 0u && (result > 0xFFFFFFFFull || result * result > value)) {
+				result--;
+			}
+			while (result < 0xFFFFFFFFull && (result + 1u) * (result + 1u) <= value) {
+				result++;
+			}
+			return result;
+		}
+
+		class WheelSieve {
+			std::vector<std::uint32_t> primes_; // 7 <= p <= sqrt(hi)
+
+		public:
+			explicit WheelSieve(std::uint64_t hi) {
+				if (hi > (1ull << 63)) {
+					error("math::primes", "the sieve only goes up to 2^63");
+				}
+				const std::uint64_t limit = detail::integer_sqrt(hi);
+				std::vector<bool> composite(static_cast<std::size_t>(limit / 2u + 1u), false); // odd numbers
+				for (std::uint64_t i = 3; i * i <= limit; i += 2) {
+					if (!composite[i / 2u]) {
+						for (std::uint64_t j = i * i; j <= limit; j += 2 * i) {
+							composite[j / 2u] = true;
+						}
+					}
+				}
+				for (std::uint64_t i = 7; i <= limit; i += 2) {
+					if (!composite[i / 2u]) {
+						primes_.push_back(static_cast<std::uint32_t>(i));
+					}
+				}
+			}
+
+			void segment(std::uint64_t low, unsigned char* bytes, std::size_t size) const {
+				// bit b of bytes[i] <=> low + 30 i + wheel_residues[b] is prime, low is a multiple of 30
+				std::fill(bytes, bytes + size, static_cast<unsigned char>(0xFFu));
+				if (low == 0u) {
+					bytes[0] &= static_cast<unsigned char>(~1u); // 1
+				}
+				const std::uint64_t high = low + 30u * size;
+				for (std::uint32_t prime : primes_) {
+					const std::uint64_t p = prime;
+					if (p * p >= high) {
+						break;
+					}
+					const std::uint64_t first = std::max(p, (low + p - 1u) / p); // crossing starts at p * p
+					for (unsigned char residue : wheel_residues) {
+						// the multiples p * k with k = residue mod 30 are p bytes apart and always on the same bit
+						const std::uint64_t k = first + (residue + 30u - first % 30u) % 30u;
+						const std::uint64_t multiple = p * k;
+						if (multiple >= high) {
+							continue;
+						}
+						const unsigned char mask = static_cast<unsigned char>(~(1u << wheel_bits[multiple % 30u]));
+						for (std::size_t i = static_cast<std::size_t>((multiple - low) / 30u); i < size; i += prime) {
+							bytes[i] &= mask;
+						}
+					}
+				}
+			}
+		};
+
+		inline std::size_t count_wheel(std::uint64_t low, unsigned char const* bytes, std::size_t size, std::uint64_t lo, std::uint64_t hi) {
+			// number of primes p of the segment with lo <= p < hi
+			std::size_t first = lo > low ? static_cast<std::size_t>((lo - low) / 30u) : 0u;
+			std::size_t last = std::min(size, static_cast<std::size_t>((hi - low + 29u) / 30u));
+			if (first >= last) {
+				return 0u;
+			}
+			std::size_t result = 0;
+			auto edge = [&](std::size_t index) { // partial byte : tests the bits one by one
+				for (unsigned int bits = bytes[index]; bits != 0u; bits &= bits - 1u) {
+					const std::uint64_t number = low + 30u * index + wheel_residues[detail::lowest_bit(bits)];
+					result += number >= lo && number < hi ? 1u : 0u;
+				}
+			};
+			edge(first++);
+			if (first < last) {
+				edge(--last);
+			}
+			for (; first + 8u <= last; first += 8u) {
+				std::uint64_t word;
+				std::memcpy(&word, bytes + first, sizeof(word));
+				result += detail::bit_count(word);
+			}
+			for (; first < last; first++) {
+				result += detail::bit_count(bytes[first]);
+			}
+			return result;
+		}
+	}
+
+	class PrimeRange {
+		/*
+		lazy range of the primes p with lo <= p < hi, in increasing order
+		thread_count() segments are sieved at a time (in parallel) => memory is O(sqrt(hi)) whatever the size of the range
+			for (unsigned long long int p : math::primes(lo, hi)) ...
+		*/
+		detail::WheelSieve sieve_;
+		std::uint64_t lo_;
+		std::uint64_t hi_;
+		std::vector<unsigned char> bytes_;
+		std::uint64_t low_ = 0u; // number of bytes_[0]
+		std::uint64_t next_low_ = 0u;
+		std::size_t byte_ = 0u; // current byte
+		std::size_t index_ = 0u; // next byte
+		unsigned int bits_ = 0u; // primes left in the current byte
+		std::size_t small_ = 0u; // next of 2, 3, 5
+
+		bool refill() {
+			if (next_low_ >= hi_) {
+				return false;
+			}
+			const std::size_t size = static_cast<std::size_t>(std::min<std::uint64_t>(math::thread_count() * detail::sieve_segment_bytes, (hi_ - next_low_ + 29u) / 30u));
+			bytes_.resize(size);
+			math::parallel_for((size + detail::sieve_segment_bytes - 1u) / detail::sieve_segment_bytes, [&](std::size_t segment) {
+				const std::size_t offset = segment * detail::sieve_segment_bytes;
+				sieve_.segment(next_low_ + 30u * offset, bytes_.data() + offset, std::min(detail::sieve_segment_bytes, size - offset));
+			});
+			low_ = next_low_;
+			next_low_ += 30u * size;
+			index_ = 0u;
+			return true;
+		}
+
+		std::uint64_t next() { // 0 at the end
+			constexpr std::uint64_t small[3] = { 2u, 3u, 5u };
+			while (small_ < 3u) {
+				const std::uint64_t prime = small[small_++];
+				if (prime >= lo_ && prime < hi_) {
+					return prime;
+				}
+			}
+			for (;;) {
+				while (bits_ == 0u) {
+					if (index_ == bytes_.size() && !refill()) {
+						return 0u;
+					}
+					byte_ = index_;
+					bits_ = bytes_[index_++];
+				}
+				const std::uint64_t prime = low_ + 30u * byte_ + detail::wheel_residues[detail::lowest_bit(bits_)];
+				bits_ &= bits_ - 1u;
+				if (prime >= hi_) {
+					next_low_ = hi_;
+					bytes_.clear();
+					index_ = 0u;
+					bits_ = 0u;
+					return 0u;
+				}
+				if (prime >= lo_) {
+					return prime;
+				}
+			}
+		}
+
+	public:
+		class iterator {
+			PrimeRange* range_ = nullptr;
+			std::uint64_t prime_ = 0u; // 0 => end
+
+		public:
+			typedef std::input_iterator_tag iterator_category;
+			typedef unsigned long long int value_type;
+			typedef std::ptrdiff_t difference_type;
+			typedef unsigned long long int const* pointer;
+			typedef unsigned long long int const& reference;
+
+			iterator() = default;
+			iterator(PrimeRange* range, std::uint64_t prime) : range_(range), prime_(prime) {}
+
+			inline unsigned long long int operator*() const {
+				return prime_;
+			}
+			inline iterator& operator++() {
+				prime_ = range_->next();
+				return *this;
+			}
+			inline iterator operator++(int) {
+				iterator result = *this;
+				++(*this);
+				return result;
+			}
+			inline bool operator==(iterator const& other) const {
+				return prime_ == other.prime_;
+			}
+			inline bool operator!=(iterator const& other) const {
+				return prime_ != other.prime_;
+			}
+		};
+
+		PrimeRange(std::uint64_t lo, std::uint64_t hi) : sieve_(hi), lo_(lo), hi_(std::max(lo, hi)) {}
+
+		iterator begin() { // starts over
+			next_low_ = lo_ - lo_ % 30u;
+			bytes_.clear();
+			index_ = 0u;
+			bits_ = 0u;
+			small_ = 0u;
+			return iterator(this, next());
+		}
+
+		iterator end() {
+			return iterator();
+		}
+	};
+
+	inline PrimeRange primes(unsigned long long int lo, unsigned long long int hi) {
+		return PrimeRange(lo, hi);
+	}
+
+	inline unsigned long long int count_primes(unsigned long long int lo, unsigned long long int hi) {
+		// number of primes p with lo <= p < hi, the segments are sieved in parallel
+		if (hi <= lo) {
+			return 0u;
+		}
+		unsigned long long int result = 0u;
+		for (unsigned long long int prime : { 2ull, 3ull, 5ull }) {
+			result += prime >= lo && prime < hi ? 1u : 0u;
+		}
+		const detail::WheelSieve sieve(hi);
+		const std::uint64_t start = lo - lo % 30u;
+		const std::uint64_t segments = (hi - start + detail::sieve_segment_span - 1u) / detail::sieve_segment_span;
+		std::atomic<unsigned long long int> total(result);
+		math::parallel_for(static_cast<std::size_t>(segments), [&](std::size_t segment) {
+			const std::uint64_t low = start + segment * detail::sieve_segment_span;
+			const std::size_t size = static_cast<std::size_t>(std::min<std::uint64_t>(detail::sieve_segment_bytes, (hi - low + 29u) / 30u));
+			std::vector<unsigned char> bytes(size);
+			sieve.segment(low, bytes.data(), size);
+			total.fetch_add(detail::count_wheel(low, bytes.data(), size, lo, hi));
+		});
+		return total.load();
+	}
+
+	namespace detail {
+
+		template<bool DOUBLE>
+		inline std::uint64_t quotient(std::uint64_t x, std::uint64_t d) {
+			// below 2^53 the rounded double quotient is never above an integer the real one is below => same floor, faster
+			if constexpr (DOUBLE) {
+				return static_cast<std::uint64_t>(static_cast<double>(x) / static_cast<double>(d));
+			}
+			else {
+				return x / d;
+			}
+		}
+
+		template<typename FUNCTION>
+		void for_range(std::uint64_t first, std::uint64_t last, FUNCTION const& function) {
+			// function(i) for i in [first, last], in parallel when the range is worth the threads
+			constexpr std::uint64_t chunk = 1u << 16;
+			if (first > last) {
+				return;
+			}
+			if (last - first < 4u * chunk) {
+				for (std::uint64_t i = first; i <= last; i++) {
+					function(i);
+				}
+				return;
+			}
+			math::parallel_for(static_cast<std::size_t>((last - first) / chunk + 1u), [&](std::size_t index) {
+				const std::uint64_t begin = first + index * chunk;
+				const std::uint64_t end = std::min(last, begin + chunk - 1u);
+				for (std::uint64_t i = begin; i <= end; i++) {
+					function(i);
+				}
+			});
+		}
+
+		template<bool DOUBLE>
+		unsigned long long int lucy_prime_pi(std::uint64_t x) {
+			/*
+			Lucy_Hedgehog : S(v) = count of the numbers in [2, v] left by the sieve of the primes < p, only for the O(sqrt x) values v = x / i
+			the prime p removes S(v / p) - S(p - 1) from every S(v) with v >= p^2 => S(x) = pi(x) at the end
+			small[v] holds S(v) for v <= sqrt(x), large[i] holds S(x / i)
+			S(v / p) must be read before its own update : the indices are cut in blocks (root / p^k, root / p^(k - 1)],
+			a block only reads the block above it (large) or below it (small) => the blocks run in order, each one in parallel
+			*/
+			const std::uint64_t root = detail::integer_sqrt(x);
+			std::vector<std::uint32_t> small(static_cast<std::size_t>(root + 1u));
+			std::vector<std::uint64_t> large(static_cast<std::size_t>(root + 1u));
+			for (std::uint64_t v = 1; v <= root; v++) {
+				small[v] = static_cast<std::uint32_t>(v - 1u);
+				large[v] = detail::quotient<DOUBLE>(x, v) - 1u;
+			}
+			std::vector<std::uint64_t> bounds;
+			for (std::uint64_t p = 2; p <= root; p++) {
+				if (small[p] == small[p - 1u]) {
+					continue; // not a prime
+				}
+				const std::uint64_t before = small[p - 1u]; // primes < p
+				const std::uint64_t square = p * p;
+				bounds.assign(1u, root);
+				while (bounds.back() != 0u) {
+					bounds.push_back(bounds.back() / p);
+				}
+				const std::uint64_t limit = std::min(root, detail::quotient<DOUBLE>(x, square));
+				for (std::size_t k = bounds.size() - 1u; k > 0u; k--) { // smallest i first
+					detail::for_range(bounds[k] + 1u, std::min(limit, bounds[k - 1u]), [&](std::uint64_t i) {
+						const std::uint64_t j = i * p;
+						const std::uint64_t count = j <= root ? large[j] : small[detail::quotient<DOUBLE>(x, j)];
+						large[i] -= count - before;
+					});
+				}
+				for (std::size_t k = 1; k < bounds.size() && bounds[k - 1u] >= square; k++) { // largest v first
+					detail::for_range(std::max(square, bounds[k] + 1u), bounds[k - 1u], [&](std::uint64_t v) {
+						small[v] -= static_cast<std::uint32_t>(small[v / p] - before);
+					});
+				}
+			}
+			return large[1];
+		}
+	}
+
+	inline unsigned long long int prime_pi(unsigned long long int x) {
+		/*
+		number of primes <= x without enumerating them (detail::lucy_prime_pi)
+		O(x^(3/4)) time and O(sqrt(x)) memory (12 bytes per number below sqrt(x)) : about 1e13 in seconds, 1e15 in minutes
+		*/
+		if (x < 2u) {
+			return 0u;
+		}
+		if (x < (1ull << 53)) {
+			return detail::lucy_prime_pi<true>(x);
+		}
+		return detail::lucy_prime_pi<false>(x);
+	}
+
+	struct FactorTableHeader {
+		char magic[8] = { 'M', 'L', 'F', 'A', 'C', 'T', 'O', 'R' };
+		std::uint32_t version = 1u;
+		std::uint32_t byte_order = 0x01020304u;
+		std::uint64_t bound = 0u;
+		std::uint64_t data_offset = 32u;
+	};
+	static_assert(sizeof(FactorTableHeader) == 32u, "math::FactorTableHeader must be 32 bytes");
+
+	class FactorTable {
+		/*
+		smallest prime factor of every n < bound => factoring n is a chain of lookups (O(log n))
+		only the odd numbers are stored : entry n / 2 is the smallest factor of the odd n, 0 if n is prime
+		a composite below 2^32 has a factor below 2^16 => 16-bit entries, 1 byte per number, bound <= 2^32
+		the table is built with a segmented sieve (the segments in parallel) or mapped from a file written by save()
+		*/
+		std::uint64_t bound_ = 0u;
+		std::vector<std::uint16_t> owned_;
+		std::unique_ptr<MappedFile> file_;
+		std::uint16_t const* factors_ = nullptr;
+
+	public:
+		explicit FactorTable(std::uint64_t bound) : bound_(bound) {
+			if (bound > (1ull << 32)) {
+				error("math::FactorTable::FactorTable", "bound must be <= 2^32");
+			}
+			const std::size_t size = static_cast<std::size_t>(bound / 2u);
+			owned_.assign(size, 0u);
+			std::vector<std::uint32_t> primes; // odd primes up to sqrt(bound)
+			for (unsigned long long int prime : math::primes(3u, detail::integer_sqrt(bound) + 1u)) {
+				primes.push_back(static_cast<std::uint32_t>(prime));
+			}
+			constexpr std::size_t segment = 1u << 16; // entries
+			std::uint16_t* factors = owned_.data();
+			math::parallel_for((size + segment - 1u) / segment, [&](std::size_t index) {
+				const std::size_t first = index * segment;
+				const std::size_t last = std::min(size, first + segment);
+				const std::uint64_t low = 2u * first + 1u; // first odd number of the segment
+				for (std::uint32_t prime : primes) { // increasing => the first prime to reach an entry is its smallest factor
+					const std::uint64_t p = prime;
+					if (p * p >= 2u * last) {
+						break;
+					}
+					const std::uint64_t k = ((low + p - 1u) / p) | 1u; // odd multiples only
+					for (std::size_t i = static_cast<std::size_t>(std::max(p * p, p * k) / 2u); i < last; i += prime) {
+						if (factors[i] == 0u) {
+							factors[i] = static_cast<std::uint16_t>(prime);
+						}
+					}
+				}
+			});
+			factors_ = owned_.data();
+		}
+
+		explicit FactorTable(std::string const& path) : file_(new MappedFile(path)) {
+			FactorTableHeader header;
+			if (file_->size() < sizeof(FactorTableHeader)) {
+				error("math::FactorTable::FactorTable", path + " is too small to be a factor table");
+			}
+			std::memcpy(&header, file_->data(), sizeof(FactorTableHeader));
+			if (std::memcmp(header.magic, FactorTableHeader().magic, 8u) != 0 || header.version != 1u) {
+				error("math::FactorTable::FactorTable", path + " is not a factor table");
+			}
+			if (header.byte_order != FactorTableHeader().byte_order) {
+				error("math::FactorTable::FactorTable", path + " was written with another byte order");
+			}
+			if (header.bound > (1ull << 32) || header.data_offset % 2u != 0u || header.data_offset > file_->size() || (file_->size() - header.data_offset) / 2u < header.bound / 2u) {
+				error("math::FactorTable::FactorTable", path + " is truncated");
+			}
+			bound_ = header.bound;
+			factors_ = reinterpret_cast<std::uint16_t const*>(file_->data() + header.data_offset);
+		}
+
+		void save(std::string const& path) const {
+			FactorTableHeader header;
+			header.bound = bound_;
+			std::ofstream file(path, std::ios::binary | std::ios::trunc);
+			if (!file) {
+				error("math::FactorTable::save", "can't open " + path);
+			}
+			file.write(reinterpret_cast<char const*>(&header), sizeof(FactorTableHeader));
+			file.write(reinterpret_cast<char const*>(factors_), static_cast<std::streamsize>(bound_ / 2u * sizeof(std::uint16_t)));
+			if (!file) {
+				error("math::FactorTable::save", "can't write " + path);
+			}
+		}
+
+		inline std::uint64_t bound() const {
+			return bound_;
+		}
+
+		inline bool covers(std::uint64_t n) const {
+			return n < bound_;
+		}
+
+		inline std::uint64_t smallest_factor(std::uint64_t n) const { // 2 <= n < bound
+			if ((n & 1u) == 0u) {
+				return 2u;
+			}
+			const std::uint64_t factor = factors_[n / 2u];
+			return factor == 0u ? n : factor;
+		}
+
+		std::vector<std::uint64_t> prime_factors(std::uint64_t n) const { // n < bound, sorted
+			std::vector<std::uint64_t> factors;
+			if (n == 0u) {
+				return factors;
+			}
+			for (; (n & 1u) == 0u; n >>= 1) {
+				factors.push_back(2u);
+			}
+			while (n > 1u) {
+				const std::uint64_t factor = smallest_factor(n);
+				factors.push_back(factor);
+				n /= factor;
+			}
+			return factors;
+		}
+	};
+
+	namespace detail {
+		struct FactorTableSetting {
+			/*
+			the table is read without lock by every prime_factors / first_divisor call (std::atomic_load on the shared_ptr),
+			the mutex only makes factor_table(bound) build a table once
+			*/
+			std::mutex mutex;
+#ifdef __cpp_lib_atomic_shared_ptr
+			std::atomic<std::shared_ptr<const FactorTable>> table;
+#else
+			std::shared_ptr<const FactorTable> table;
+#endif
+			std::atomic<std::uint64_t> bound{ 0u }; // table->bound() => no shared_ptr read at all when n isn't covered
+
+			inline std::shared_ptr<const FactorTable> load() const {
+#ifdef __cpp_lib_atomic_shared_ptr
+				return table.load(std::memory_order_acquire);
+#else
+				return std::atomic_load_explicit(&table, std::memory_order_acquire);
+#endif
+			}
+
+			inline void store(std::shared_ptr<const FactorTable> value) {
+				bound.store(value != nullptr ? value->bound() : 0u, std::memory_order_release);
+#ifdef __cpp_lib_atomic_shared_ptr
+				table.store(std::move(value), std::memory_order_release);
+#else
+				std::atomic_store_explicit(&table, std::move(value), std::memory_order_release);
+#endif
+			}
+		};
+
+		inline FactorTableSetting& factor_table_setting() {
+			static FactorTableSetting setting;
+			return setting;
+		}
+
+		inline std::shared_ptr<const FactorTable> covering_factor_table(std::uint64_t n) {
+			// the shared table if it covers n, null otherwise
+			FactorTableSetting const& setting = detail::factor_table_setting();
+			if (n >= setting.bound.load(std::memory_order_acquire)) {
+				return nullptr;
+			}
+			std::shared_ptr<const FactorTable> table = setting.load();
+			return table != nullptr && table->covers(n) ? table : nullptr;
+		}
+	}
+
+	inline std::shared_ptr<const FactorTable> factor_table() { // the table used by prime_factors and first_divisor, may be null
+		return detail::factor_table_setting().load();
+	}
+
+	inline void factor_table(std::shared_ptr<const FactorTable> table) {
+		// shares a table (built or loaded) with prime_factors and first_divisor, null to stop using one
+		detail::FactorTableSetting& setting = detail::factor_table_setting();
+		const std::lock_guard<std::mutex> lock(setting.mutex);
+		setting.store(std::move(table));
+	}
+
+	inline std::shared_ptr<const FactorTable> factor_table(std::uint64_t bound) {
+		// the shared table, built (once) on the first call asking for a bound it doesn't cover
+		detail::FactorTableSetting& setting = detail::factor_table_setting();
+		const std::lock_guard<std::mutex> lock(setting.mutex);
+		std::shared_ptr<const FactorTable> table = setting.load();
+		if (table == nullptr || table->bound() < bound) {
+			table = std::make_shared<const FactorTable>(bound);
+			setting.store(table);
+		}
+		return table;
+	}
+
+	namespace detail {
+
+		constexpr std::uint64_t trial_division_limit = 1u << 10;
+
+		inline std::uint64_t pollard_brent(std::uint64_t n) {
+			/*
+			a divisor 1 < d < n of an odd composite n without small factors
+			Pollard rho with Brent's cycle detection : the differences are multiplied together in Montgomery form
+			and only every 128 steps go through a gcd, the last batch is replayed one step at a time if the gcd gives n
+			*/
+			constexpr std::uint64_t batch = 128u;
+			const Montgomery field(n);
+			for (std::uint64_t c = 1;; c++) {
+				const std::uint64_t increment = field.to(c % n);
+				auto step = [&](std::uint64_t value) { // value^2 + c mod n
+					const std::uint64_t square = field.multiply(value, value);
+					return square >= n - increment ? square - (n - increment) : square + increment;
+				};
+				auto distance = [](std::uint64_t a, std::uint64_t b) {
+					return a > b ? a - b : b - a;
+				};
+				std::uint64_t x = 0u;
+				std::uint64_t y = field.to(2u);
+				std::uint64_t saved = y;
+				std::uint64_t product = field.to(1u);
+				std::uint64_t divisor = 1u;
+				for (std::uint64_t length = 1; divisor == 1u; length <<= 1) {
+					x = y;
+					for (std::uint64_t i = 0; i < length; i++) {
+						y = step(y);
+					}
+					for (std::uint64_t done = 0; done < length && divisor == 1u; done += batch) {
+						saved = y;
+						const std::uint64_t count = std::min(batch, length - done);
+						for (std::uint64_t i = 0; i < count; i++) {
+							y = step(y);
+							product = field.multiply(product, distance(x, y));
+						}
+						divisor = std::gcd(product, n); // the 2^64 factor of the Montgomery form is coprime to n
+					}
+				}
+				if (divisor == n) {
+					do {
+						saved = step(saved);
+						divisor = std::gcd(distance(x, saved), n);
+					} while (divisor == 1u);
+				}
+				if (divisor != n) {
+					return divisor;
+				}
+			}
+		}
+
+		inline void factorize(std::uint64_t n, std::vector<std::uint64_t>& factors) {
+			// appends the prime factors of n (unsorted), n has no factor below trial_division_limit
+			if (n == 1u) {
+				return;
+			}
+			if (detail::is_prime(n)) {
+				factors.push_back(n);
+				return;
+			}
+			const std::uint64_t divisor = detail::pollard_brent(n);
+			detail::factorize(divisor, factors);
+			detail::factorize(n / divisor, factors);
+		}
+
+		inline std::vector<std::uint64_t> prime_factors(std::uint64_t n) {
+			// sorted prime factors with repetitions, empty for 0 and 1
+			if (const std::shared_ptr<const FactorTable> table = detail::covering_factor_table(n)) {
+				return table->prime_factors(n);
+			}
+			std::vector<std::uint64_t> factors;
+			if (n == 0u) {
+				return factors;
+			}
+			for (; (n & 1u) == 0u; n >>= 1) {
+				factors.push_back(2u);
+			}
+			for (std::uint64_t p = 3; p < trial_division_limit && p * p <= n; p += 2) {
+				if (small_primes.test(p)) {
+					for (; n % p == 0u; n /= p) {
+						factors.push_back(p);
+					}
+				}
+			}
+			if (n < trial_division_limit * trial_division_limit) {
+				if (n > 1u) {
+					factors.push_back(n);
+				}
+				return factors;
+			}
+			const std::size_t small = factors.size();
+			detail::factorize(n, factors);
+			std::sort(factors.begin() + static_cast<std::ptrdiff_t>(small), factors.end());
+			return factors;
+		}
+
+		inline std::uint64_t first_divisor(std::uint64_t n) {
+			// smallest prime factor, n for 0 and 1
+			if (n < 4u || (n & 1u) == 0u) {
+				return n < 4u ? n : 2u;
+			}
+			if (const std::shared_ptr<const FactorTable> table = detail::covering_factor_table(n)) {
+				return table->smallest_factor(n);
+			}
+			for (std::uint64_t p = 3; p < trial_division_limit && p * p <= n; p += 2) {
+				if (small_primes.test(p) && n % p == 0u) {
+					return p;
+				}
+			}
+			if (n < trial_division_limit * trial_division_limit || detail::is_prime(n)) {
+				return n;
+			}
+			std::vector<std::uint64_t> factors;
+			detail::factorize(n, factors);
+			return *std::min_element(factors.begin(), factors.end());
+		}
+	}
+
+	inline long long int first_divisor(long long int number) {
+		// smallest prime factor (with the sign of number), number itself for -1, 0 and 1
+		const std::uint64_t n = static_cast<std::uint64_t>(number);
+		const std::uint64_t divisor = detail::first_divisor(number < 0 ? 0u - n : n);
+		return number < 0 ? 0 - static_cast<long long int>(divisor) : static_cast<long long int>(divisor);
+	}
+
+	inline std::vector<long long int> prime_factors(long long int number) {
+		// prime factors in increasing order with repetitions, negated for a negative number (-12 => [-2, -2, -3])
+		const std::uint64_t n = static_cast<std::uint64_t>(number);
+		const std::vector<std::uint64_t> factors = detail::prime_factors(number < 0 ? 0u - n : n);
+		std::vector<long long int> result(factors.size());
+		for (std::size_t i = 0; i < factors.size(); i++) {
+			result[i] = number < 0 ? 0 - static_cast<long long int>(factors[i]) : static_cast<long long int>(factors[i]);
+		}
+		return result;
+	}
+
+	inline std::vector<std::pair<long long int, unsigned int>> prime_factorization(long long int number) {
+		// the same factors as (prime, exponent) pairs : 360 => [(2, 3), (3, 2), (5, 1)]
+		const std::vector<long long int> factors = math::prime_factors(number);
+		std::vector<std::pair<long long int, unsigned int>> result;
+		for (long long int factor : factors) {
+			if (result.empty() || result.back().first != factor) {
+				result.emplace_back(factor, 0u);
+			}
+			result.back().second++;
+		}
+		return result;
+	}
+}
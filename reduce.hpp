@@ -0,0 +1,71 @@
+#pragma once
+
+#include "include.hpp"
+#include "parallel.hpp"
+
+/*
+reductions used by math::Matrix2D
+the values are always cut in the same blocks and combined in the same order (pairwise / tree),
+whatever the number of threads => a floating point result only depends on the data
+*/
+
+namespace math {
+
+	namespace detail {
+
+		constexpr std::size_t reduction_block = 1u << 14; // values per task
+		constexpr std::size_t pairwise_leaf = 64u; // under this size, values are added with 8 accumulators
+
+		template<typename NUMBER>
+		NUMBER pairwise_sum(NUMBER const* values, std::size_t count) {
+			if (count <= pairwise_leaf) {
+				NUMBER partial[8];
+				std::fill(partial, partial + 8, NUMBER());
+				std::size_t i = 0;
+				for (; i + 8u <= count; i += 8u) { // 8 independent sums => vectorized
+					for (std::size_t j = 0; j < 8u; j++) {
+						partial[j] += values[i + j];
+					}
+				}
+				for (; i < count; i++) {
+					partial[i % 8u] += values[i];
+				}
+				return ((partial[0] + partial[1]) + (partial[2] + partial[3])) + ((partial[4] + partial[5]) + (partial[6] + partial[7]));
+			}
+			const std::size_t half = count / 2u;
+			return pairwise_sum(values, half) + pairwise_sum(values + half, count - half);
+		}
+
+		template<typename NUMBER>
+		void tree_combine(std::vector<NUMBER>& partials) {
+			// partials[0] = pairwise sum of partials, in an order that only depends on partials.size()
+			for (std::size_t step = 1u; step < partials.size(); step *= 2u) {
+				for (std::size_t i = 0; i + step < partials.size(); i += 2u * step) {
+					partials[i] += partials[i + step];
+				}
+			}
+		}
+
+		template<typename NUMBER>
+		void tree_combine(std::vector<std::vector<NUMBER>>& partials) {
+			// same as above for each index, the columns are split between the threads
+			if (partials.empty()) {
+				return;
+			}
+			const std::size_t size = partials[0].size();
+			math::parallel_for((size + reduction_block - 1u) / reduction_block, [&](std::size_t task) {
+				const std::size_t first = task * reduction_block;
+				const std::size_t last = std::min(size, first + reduction_block);
+				for (std::size_t step = 1u; step < partials.size(); step *= 2u) {
+					for (std::size_t i = 0; i + step < partials.size(); i += 2u * step) {
+						std::vector<NUMBER>& target = partials[i];
+						std::vector<NUMBER> const& source = partials[i + step];
+						for (std::size_t j = first; j < last; j++) {
+							target[j] += source[j];
+						}
+					}
+				}
+			});
+		}
+	}
+}
@@ -0,0 +1,336 @@
+#pragma once
+
+#include "include.hpp"
+#include "matrix.hpp"
+#include "parallel.hpp"
+#include "reduce.hpp"
+
+enum class sparse_layout { CSR, CSC };
+
+/*
+CSR (compressed sparse rows) :
+	1 0 0 2
+	0 0 3 0    => offsets = { 0, 2, 3, 4 }, indexes = { 0, 3, 2, 1 }, values = { 1, 2, 3, 4 }
+	0 4 0 0
+line i has the values values[offsets[i] .. offsets[i + 1]] at the columns indexes[offsets[i] .. offsets[i + 1]]
+CSC is the same with the columns instead of the lines
+only the non zero values (!= NUMBER()) are stored => O(non zeros) memory
+*/
+
+namespace math {
+
+	namespace detail {
+		constexpr std::size_t sparse_partials = 16u; // max number of dense partial results of a CSC matrix * vector
+	}
+
+	template<typename NUMBER>
+	class SparseMatrix;
+
+	template<typename NUMBER>
+	class SparseBuilder {
+		// coordinates list (COO) : values are added in any order then sorted once by build()
+		std::size_t lines_ = 0u;
+		std::size_t columns_ = 0u;
+		std::vector<std::size_t> lines_indexes_;
+		std::vector<std::size_t> columns_indexes_;
+		std::vector<NUMBER> values_;
+
+	public:
+		SparseBuilder(std::size_t lines, std::size_t columns) : lines_(lines), columns_(columns) {}
+
+		void reserve(std::size_t values) {
+			lines_indexes_.reserve(values);
+			columns_indexes_.reserve(values);
+			values_.reserve(values);
+		}
+
+		void add(std::size_t line, std::size_t column, NUMBER value) { // values added twice at the same place are summed
+			if (line >= lines_ || column >= columns_) {
+				error("math::SparseBuilder::add", "(" + std::to_string(line) + ", " + std::to_string(column) + ") is out of the " + std::to_string(lines_) + "x" + std::to_string(columns_) + " matrix");
+			}
+			lines_indexes_.push_back(line);
+			columns_indexes_.push_back(column);
+			values_.push_back(value);
+		}
+
+		inline std::size_t size() const {
+			return values_.size();
+		}
+
+		SparseMatrix<NUMBER> build(sparse_layout layout = sparse_layout::CSR) const {
+			const bool csr = layout == sparse_layout::CSR;
+			std::vector<std::size_t> const& major = csr ? lines_indexes_ : columns_indexes_;
+			std::vector<std::size_t> const& minor = csr ? columns_indexes_ : lines_indexes_;
+			const std::size_t major_size = csr ? lines_ : columns_;
+			const std::size_t minor_size = csr ? columns_ : lines_;
+
+			// 2 passes of counting sort (minor then major, stable) => sorted by (major, minor) in O(values + lines + columns)
+			std::vector<std::size_t> by_minor(values_.size());
+			std::vector<std::size_t> counts(minor_size + 1u, 0u);
+			for (std::size_t index : minor) {
+				counts[index + 1u]++;
+			}
+			std::partial_sum(counts.begin(), counts.end(), counts.begin());
+			for (std::size_t i = 0; i < values_.size(); i++) {
+				by_minor[counts[minor[i]]++] = i;
+			}
+			std::vector<std::size_t> order(values_.size());
+			counts.assign(major_size + 1u, 0u);
+			for (std::size_t index : major) {
+				counts[index + 1u]++;
+			}
+			std::partial_sum(counts.begin(), counts.end(), counts.begin());
+			for (std::size_t i : by_minor) {
+				order[counts[major[i]]++] = i;
+			}
+
+			SparseMatrix<NUMBER> result(lines_, columns_, layout);
+			result.offsets_.assign(major_size + 1u, 0u);
+			result.indexes_.reserve(values_.size());
+			result.values_.reserve(values_.size());
+			std::size_t position = 0;
+			for (std::size_t line = 0; line < major_size; line++) {
+				const std::size_t first = result.values_.size();
+				for (; position < order.size() && major[order[position]] == line; position++) {
+					const std::size_t i = order[position];
+					if (result.values_.size() > first && result.indexes_.back() == minor[i]) {
+						result.values_.back() += values_[i]; // duplicate
+					}
+					else {
+						result.indexes_.push_back(minor[i]);
+						result.values_.push_back(values_[i]);
+					}
+				}
+				result.offsets_[line + 1u] = result.values_.size();
+			}
+			result.drop_zeros();
+			return result;
+		}
+	};
+
+	template<typename NUMBER>
+	class SparseMatrix {
+		friend class SparseBuilder<NUMBER>;
+
+		std::size_t lines_ = 0u;
+		std::size_t columns_ = 0u;
+		sparse_layout layout_ = sparse_layout::CSR;
+		std::vector<std::size_t> offsets_; // major_size() + 1 values
+		std::vector<std::size_t> indexes_;
+		std::vector<NUMBER> values_;
+
+		inline std::size_t major_size() const {
+			return layout_ == sparse_layout::CSR ? lines_ : columns_;
+		}
+
+		void drop_zeros() {
+			// removes the values equal to NUMBER() (ex : duplicates summed to 0)
+			std::size_t kept = 0;
+			std::size_t first = 0;
+			for (std::size_t major = 0; major < major_size(); major++) {
+				const std::size_t last = offsets_[major + 1u];
+				for (std::size_t i = first; i < last; i++) {
+					if (values_[i] != NUMBER()) {
+						indexes_[kept] = indexes_[i];
+						values_[kept] = values_[i];
+						kept++;
+					}
+				}
+				first = last;
+				offsets_[major + 1u] = kept;
+			}
+			indexes_.resize(kept);
+			values_.resize(kept);
+		}
+
+		std::vector<std::size_t> tasks(std::size_t max_tasks = static_cast<std::size_t>(-1)) const {
+			// splits the major indexes in tasks of about detail::reduction_block values (at most max_tasks), the split only depends on the matrix
+			std::vector<std::size_t> bounds = { 0u };
+			const std::size_t count = std::max<std::size_t>(1u, std::min({ major_size(), values_.size() / detail::reduction_block, max_tasks }));
+			for (std::size_t task = 1; task < count; task++) {
+				const std::size_t target = values_.size() * task / count;
+				bounds.push_back(std::max(bounds.back(), static_cast<std::size_t>(std::lower_bound(offsets_.begin(), offsets_.end(), target) - offsets_.begin())));
+			}
+			bounds.push_back(major_size());
+			return bounds;
+		}
+
+	public:
+		SparseMatrix(std::size_t lines = 0u, std::size_t columns = 0u, sparse_layout layout = sparse_layout::CSR) : lines_(lines), columns_(columns), layout_(layout), offsets_(major_size() + 1u, 0u) {}
+
+		SparseMatrix(Matrix2D<NUMBER> const& matrix, sparse_layout layout = sparse_layout::CSR) : SparseMatrix(matrix.lines(), matrix.columns(), sparse_layout::CSR) {
+			for (std::size_t line = 0; line < lines_; line++) {
+				NUMBER const* values = matrix.data() + line * matrix.stride();
+				for (std::size_t column = 0; column < columns_; column++) {
+					if (values[column] != NUMBER()) {
+						indexes_.push_back(column);
+						values_.push_back(values[column]);
+					}
+				}
+				offsets_[line + 1u] = values_.size();
+			}
+			if (layout != sparse_layout::CSR) {
+				*this = convert(layout);
+			}
+		}
+
+		Matrix2D<NUMBER> to_matrix2d() const {
+			Matrix2D<NUMBER> result(lines_, columns_);
+			NUMBER* values = result.data();
+			for (std::size_t major = 0; major < major_size(); major++) {
+				for (std::size_t i = offsets_[major]; i < offsets_[major + 1u]; i++) {
+					if (layout_ == sparse_layout::CSR) {
+						values[major * result.stride() + indexes_[i]] = values_[i];
+					}
+					else {
+						values[indexes_[i] * result.stride() + major] = values_[i];
+					}
+				}
+			}
+			return result;
+		}
+
+		SparseMatrix convert(sparse_layout layout) const {
+			// CSR <=> CSC with a counting sort, O(non zeros + lines + columns)
+			if (layout == layout_) {
+				return *this;
+			}
+			SparseMatrix result(lines_, columns_, layout);
+			std::vector<std::size_t>& offsets = result.offsets_;
+			for (std::size_t index : indexes_) {
+				offsets[index + 1u]++;
+			}
+			std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+			result.indexes_.resize(values_.size());
+			result.values_.resize(values_.size());
+			std::vector<std::size_t> next(offsets.begin(), offsets.end() - 1);
+			for (std::size_t major = 0; major < major_size(); major++) { // majors are visited in order => minors of result are sorted
+				for (std::size_t i = offsets_[major]; i < offsets_[major + 1u]; i++) {
+					const std::size_t position = next[indexes_[i]]++;
+					result.indexes_[position] = major;
+					result.values_[position] = values_[i];
+				}
+			}
+			return result;
+		}
+
+		SparseMatrix transpose() const {
+			// the CSR of a matrix is the CSC of its transpose => only the metadata changes
+			SparseMatrix result = *this;
+			std::swap(result.lines_, result.columns_);
+			result.layout_ = layout_ == sparse_layout::CSR ? sparse_layout::CSC : sparse_layout::CSR;
+			return result;
+		}
+
+		inline std::size_t lines() const {
+			return lines_;
+		}
+
+		inline std::size_t columns() const {
+			return columns_;
+		}
+
+		inline std::size_t non_zeros() const {
+			return values_.size();
+		}
+
+		inline sparse_layout layout() const {
+			return layout_;
+		}
+
+		inline std::vector<std::size_t> const& offsets() const {
+			return offsets_;
+		}
+
+		inline std::vector<std::size_t> const& indexes() const {
+			return indexes_;
+		}
+
+		inline std::vector<NUMBER> const& values() const {
+			return values_;
+		}
+
+		NUMBER value(std::size_t line, std::size_t column) const { // binary search in the line (CSR) or the column (CSC)
+			if (line >= lines_ || column >= columns_) {
+				error("math::SparseMatrix::value", "(" + std::to_string(line) + ", " + std::to_string(column) + ") is out of range");
+			}
+			const std::size_t major = layout_ == sparse_layout::CSR ? line : column;
+			const std::size_t minor = layout_ == sparse_layout::CSR ? column : line;
+			auto first = indexes_.begin() + offsets_[major];
+			auto last = indexes_.begin() + offsets_[major + 1u];
+			auto found = std::lower_bound(first, last, minor);
+			return found != last && *found == minor ? values_[found - indexes_.begin()] : NUMBER();
+		}
+
+		std::vector<NUMBER> operator*(std::vector<NUMBER> const& vector) const {
+			/*
+			sparse matrix * vector
+			CSR : every task computes its own lines
+			CSC : every task adds its columns to its own result, the results are summed in a fixed order
+				a result is lines() long => at most detail::sparse_partials of them and no more than non zeros / lines()
+				(a fixed count, the sum doesn't depend on the number of threads)
+			*/
+			if (vector.size() != columns_) {
+				error("math::SparseMatrix::operator*", "vector's size (" + std::to_string(vector.size()) + ") != columns() (" + std::to_string(columns_) + ")");
+			}
+			const std::vector<std::size_t> bounds = layout_ == sparse_layout::CSR ? tasks() : tasks(std::min(detail::sparse_partials, values_.size() / std::max<std::size_t>(1u, lines_)));
+			if (layout_ == sparse_layout::CSR) {
+				std::vector<NUMBER> result(lines_, NUMBER());
+				math::parallel_for(bounds.size() - 1u, [&](std::size_t task) {
+					for (std::size_t line = bounds[task]; line < bounds[task + 1u]; line++) {
+						NUMBER sum = NUMBER();
+						for (std::size_t i = offsets_[line]; i < offsets_[line + 1u]; i++) {
+							sum += values_[i] * vector[indexes_[i]];
+						}
+						result[line] = sum;
+					}
+				});
+				return result;
+			}
+			std::vector<std::vector<NUMBER>> partials(bounds.size() - 1u);
+			math::parallel_for(partials.size(), [&](std::size_t task) {
+				std::vector<NUMBER>& result = partials[task];
+				result.assign(lines_, NUMBER());
+				for (std::size_t column = bounds[task]; column < bounds[task + 1u]; column++) {
+					const NUMBER factor = vector[column];
+					for (std::size_t i = offsets_[column]; i < offsets_[column + 1u]; i++) {
+						result[indexes_[i]] += values_[i] * factor;
+					}
+				}
+			});
+			detail::tree_combine(partials);
+			return partials[0];
+		}
+
+		Matrix2D<NUMBER> operator*(Matrix2D<NUMBER> const& matrix) const {
+			// sparse matrix * dense matrix : every line of the result is a sum of lines of matrix
+			if (matrix.lines() != columns_) {
+				error("math::SparseMatrix::operator*", "matrix.lines() (" + std::to_string(matrix.lines()) + ") != columns() (" + std::to_string(columns_) + ")");
+			}
+			if (layout_ != sparse_layout::CSR) {
+				return convert(sparse_layout::CSR) * matrix;
+			}
+			Matrix2D<NUMBER> result(lines_, matrix.columns());
+			NUMBER* target = result.data();
+			const std::vector<std::size_t> bounds = tasks();
+			math::parallel_for(bounds.size() - 1u, [&](std::size_t task) {
+				for (std::size_t line = bounds[task]; line < bounds[task + 1u]; line++) {
+					NUMBER* result_line = target + line * result.stride();
+					for (std::size_t i = offsets_[line]; i < offsets_[line + 1u]; i++) {
+						const NUMBER factor = values_[i];
+						NUMBER const* source = matrix.data() + indexes_[i] * matrix.stride();
+						for (std::size_t column = 0; column < matrix.columns(); column++) {
+							result_line[column] += factor * source[column];
+						}
+					}
+				}
+			});
+			return result;
+		}
+	};
+
+	typedef math::SparseMatrix<int> ISparseMatrix;
+	typedef math::SparseMatrix<float> FSparseMatrix;
+	typedef math::SparseMatrix<long long int> LISparseMatrix;
+	typedef math::SparseMatrix<long double> LFSparseMatrix;
+}
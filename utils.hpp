@@ -1,55 +1,114 @@
-#include "include.hpp"
-
-namespace math {
-
-	inline std::string reduce_number(std::string number) { //  number will be copied and modified
-		while (true) {
-			if (number[number.size() - 1] == '.') {
-				return number.substr(0, number.size() - 1);
-			}
-			if (number[number.size() - 1] != '0') {
-				return number;
-			}
-			else {
-				if (std::find(number.begin(), number.end(), '.') == number.end()) { // if there's not any comma, the number is good 
-					return number;
-				}
-				else { // finished with a zero without any comma
-					number = number.substr(0, number.size() - 1); // zero deleted
-				}
-			}
-		}
-	}
-
-	template<typename NUMBER>
-	inline std::string reduce_number(NUMBER number) {
-		return math::reduce_number(std::to_string(number));
-	}
-
-	template<typename NUMBER>
-	inline void reduce_number(std::vector<NUMBER>& numbers) {
-		for (std::size_t i = 0; i < numbers.size(); i++) {
-			numbers[i] = static_cast<NUMBER>(std::stold(math::reduce_number<NUMBER>(numbers[i])));
-		}
-	}
-
-	inline bool is_number(std::string const& number) {
-		const std::string chars = "0123456789.";
-		for (char c : number) {
-			if (std::find(chars.begin(), chars.end(), c) == chars.end()) {
-				return false;
-			}
-		}
-		// find errors like 8..3 or 6.5.2
-		bool has_comma = false;
-		for (std::size_t i = 0; i < number.size(); i++) {
-			if (number[i] == '.') {
-				if (has_comma) {
-					return false;
-				}
-				has_comma = true;
-			}
-		}
-		return true;
-	}
+#pragma once
+
+#include "include.hpp"
+#include <charconv>
+#include <string_view>
+#include <type_traits>
+
+namespace math {
+
+	inline std::string reduce_number(std::string number) { //  number will be copied and modified
+		while (true) {
+			if (number[number.size() - 1] == '.') {
+				return number.substr(0, number.size() - 1);
+			}
+			if (number[number.size() - 1] != '0') {
+				return number;
+			}
+			else {
+				if (std::find(number.begin(), number.end(), '.') == number.end()) { // if there's not any comma, the number is good 
+					return number;
+				}
+				else { // finished with a zero without any comma
+					number = number.substr(0, number.size() - 1); // zero deleted
+				}
+			}
+		}
+	}
+
+	template<typename NUMBER>
+	inline std::string reduce_number(NUMBER number) {
+		return math::reduce_number(std::to_string(number));
+	}
+
+	template<typename NUMBER, typename ALLOCATOR>
+	inline void reduce_number(std::vector<NUMBER, ALLOCATOR>& numbers) {
+		for (std::size_t i = 0; i < numbers.size(); i++) {
+			numbers[i] = static_cast<NUMBER>(std::stold(math::reduce_number<NUMBER>(numbers[i])));
+		}
+	}
+
+	constexpr std::size_t max_number_size = 5000u; // enough for any long double written by format_number
+
+	template<typename NUMBER>
+	inline std::size_t format_number(NUMBER number, char* buffer) {
+		/*
+		writes math::reduce_number(number) in buffer (at least max_number_size chars), without any allocation
+		returns the number of chars written
+		*/
+		if constexpr (std::is_integral<NUMBER>::value) {
+			return static_cast<std::size_t>(std::to_chars(buffer, buffer + max_number_size, number).ptr - buffer);
+		}
+		else if constexpr (std::is_floating_point<NUMBER>::value) {
+			// same digits as std::to_string (%f), then the zeros after the comma are removed
+			std::size_t size = static_cast<std::size_t>(std::to_chars(buffer, buffer + max_number_size, number, std::chars_format::fixed, 6).ptr - buffer);
+			if (std::find(buffer, buffer + size, '.') != buffer + size) {
+				while (buffer[size - 1u] == '0') {
+					size--;
+				}
+				if (buffer[size - 1u] == '.') {
+					size--;
+				}
+			}
+			return size;
+		}
+		else {
+			std::ostringstream stream;
+			stream << number;
+			const std::string text = stream.str().substr(0, max_number_size);
+			std::copy(text.begin(), text.end(), buffer);
+			return text.size();
+		}
+	}
+
+	template<typename NUMBER>
+	inline char const* parse_number(char const* first, char const* last, NUMBER& number) {
+		// reads a number at first, returns the end of the number (first if there isn't any)
+		if (first != last && *first == '+') { // from_chars doesn't accept '+'
+			first++;
+		}
+		if constexpr (std::is_arithmetic<NUMBER>::value) {
+			const std::from_chars_result result = std::from_chars(first, last, number);
+			return result.ec == std::errc() ? result.ptr : first;
+		}
+		else {
+			long double value = 0;
+			const std::from_chars_result result = std::from_chars(first, last, value);
+			if (result.ec != std::errc()) {
+				return first;
+			}
+			number = static_cast<NUMBER>(value);
+			return result.ptr;
+		}
+	}
+
+	inline bool is_number(std::string const& number) {
+		const std::string chars = "0123456789.";
+		for (char c : number) {
+			if (std::find(chars.begin(), chars.end(), c) == chars.end()) {
+				return false;
+			}
+		}
+		// find errors like 8..3 or 6.5.2
+		bool has_comma = false;
+		for (std::size_t i = 0; i < number.size(); i++) {
+			if (number[i] == '.') {
+				if (has_comma) {
+					return false;
+				}
+				has_comma = true;
+			}
+		}
+		return true;
+	}
 }
\ No newline at end of file